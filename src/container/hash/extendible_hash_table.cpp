@@ -11,7 +11,10 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
+#include <mutex>  // NOLINT
 #include <string>
 #include <utility>
 #include <vector>
@@ -35,11 +38,12 @@ HASH_TABLE_TYPE::ExtendibleHashTable(const std::string &name, BufferPoolManager
   directory->SetPageId(directory_page_id_);
   // 2. allocate a page for bucket 0;
   page_id_t bucket_0;
-  buffer_pool_manager_->NewPage(&bucket_0, nullptr);
+  Page *bucket_page = buffer_pool_manager_->NewPage(&bucket_0, nullptr);
+  reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(bucket_page->GetData())->Init();
   directory->SetBucketPageId(0, bucket_0);
 
   // 3. and then write them back
-  buffer_pool_manager->UnpinPage(bucket_0, false);
+  buffer_pool_manager->UnpinPage(bucket_0, true);
   buffer_pool_manager->UnpinPage(directory_page_id_, true);
 }
 
@@ -85,6 +89,178 @@ auto HASH_TABLE_TYPE::FetchBucketPage(page_id_t bucket_page_id) -> HASH_TABLE_BU
 
   return bucket;
 }
+
+/*****************************************************************************
+ * OVERFLOW CHAINS
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::ChainGetValue(HASH_TABLE_BUCKET_TYPE *bucket, const KeyType &key,
+                                    std::vector<ValueType> *result) -> bool {
+  bool res = bucket->GetValue(key, comparator_, result);
+  page_id_t page_id = bucket->GetOverflowPageId();
+  while (page_id != INVALID_PAGE_ID) {
+    HASH_TABLE_BUCKET_TYPE *page = FetchBucketPage(page_id);
+    res = page->GetValue(key, comparator_, result) || res;
+    page_id_t next_page_id = page->GetOverflowPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  return res;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::ChainIsFull(HASH_TABLE_BUCKET_TYPE *bucket) -> bool {
+  if (!bucket->IsFull()) {
+    return false;
+  }
+  page_id_t page_id = bucket->GetOverflowPageId();
+  while (page_id != INVALID_PAGE_ID) {
+    HASH_TABLE_BUCKET_TYPE *page = FetchBucketPage(page_id);
+    bool full = page->IsFull();
+    page_id_t next_page_id = page->GetOverflowPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    if (!full) {
+      return false;
+    }
+    page_id = next_page_id;
+  }
+  return true;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::ChainInsert(HASH_TABLE_BUCKET_TYPE *bucket, const KeyType &key, const ValueType &value)
+    -> bool {
+  if (bucket->GetOverflowPageId() == INVALID_PAGE_ID && !bucket->IsFull()) {
+    // a single page checks for duplicates itself
+    return bucket->Insert(key, value, comparator_);
+  }
+
+  // reject a duplicate anywhere in the chain before picking a page for the pair
+  std::vector<ValueType> values;
+  ChainGetValue(bucket, key, &values);
+  if (std::find(values.begin(), values.end(), value) != values.end()) {
+    return false;
+  }
+  if (bucket->Insert(key, value, comparator_)) {
+    return true;
+  }
+
+  // the first page with a free slot takes the pair, otherwise a new page is linked at the end
+  HASH_TABLE_BUCKET_TYPE *last = bucket;
+  page_id_t last_page_id = INVALID_PAGE_ID;
+  while (last->GetOverflowPageId() != INVALID_PAGE_ID) {
+    page_id_t page_id = last->GetOverflowPageId();
+    HASH_TABLE_BUCKET_TYPE *page = FetchBucketPage(page_id);
+    if (last_page_id != INVALID_PAGE_ID) {
+      buffer_pool_manager_->UnpinPage(last_page_id, false);
+    }
+    if (page->Insert(key, value, comparator_)) {
+      buffer_pool_manager_->UnpinPage(page_id, true);
+      return true;
+    }
+    last = page;
+    last_page_id = page_id;
+  }
+
+  page_id_t overflow_page_id;
+  Page *overflow_page = buffer_pool_manager_->NewPage(&overflow_page_id, nullptr);
+  bool ok = overflow_page != nullptr;
+  if (ok) {
+    auto *overflow = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(overflow_page->GetData());
+    overflow->Init();
+    overflow->Insert(key, value, comparator_);
+    last->SetOverflowPageId(overflow_page_id);
+    buffer_pool_manager_->UnpinPage(overflow_page_id, true);
+  }
+  if (last_page_id != INVALID_PAGE_ID) {
+    buffer_pool_manager_->UnpinPage(last_page_id, ok);
+  }
+  return ok;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::ChainRemove(HASH_TABLE_BUCKET_TYPE *bucket, const KeyType &key, const ValueType &value)
+    -> bool {
+  if (bucket->Remove(key, value, comparator_)) {
+    page_id_t page_id = bucket->GetOverflowPageId();
+    if (bucket->IsEmpty() && page_id != INVALID_PAGE_ID) {
+      // keep the primary page non-empty while a chain hangs off it, so that an
+      // empty primary page always means an empty bucket
+      HASH_TABLE_BUCKET_TYPE *page = FetchBucketPage(page_id);
+      for (uint32_t i = 0; i < BUCKET_ARRAY_SIZE && page->IsOccupied(i); i++) {
+        if (page->IsReadable(i)) {
+          bucket->Insert(page->KeyAt(i), page->ValueAt(i), comparator_);
+        }
+      }
+      bucket->SetOverflowPageId(page->GetOverflowPageId());
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      buffer_pool_manager_->DeletePage(page_id);
+    }
+    return true;
+  }
+
+  HASH_TABLE_BUCKET_TYPE *prev = bucket;
+  page_id_t prev_page_id = INVALID_PAGE_ID;
+  page_id_t page_id = bucket->GetOverflowPageId();
+  bool ok = false;
+  while (page_id != INVALID_PAGE_ID) {
+    HASH_TABLE_BUCKET_TYPE *page = FetchBucketPage(page_id);
+    if (page->Remove(key, value, comparator_)) {
+      ok = true;
+      if (page->IsEmpty()) {
+        prev->SetOverflowPageId(page->GetOverflowPageId());
+        buffer_pool_manager_->UnpinPage(page_id, false);
+        buffer_pool_manager_->DeletePage(page_id);
+      } else {
+        buffer_pool_manager_->UnpinPage(page_id, true);
+      }
+      break;
+    }
+    if (prev_page_id != INVALID_PAGE_ID) {
+      buffer_pool_manager_->UnpinPage(prev_page_id, false);
+    }
+    prev = page;
+    prev_page_id = page_id;
+    page_id = page->GetOverflowPageId();
+  }
+  if (prev_page_id != INVALID_PAGE_ID) {
+    buffer_pool_manager_->UnpinPage(prev_page_id, ok);
+  }
+  return ok;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::SplitCanSeparate(HASH_TABLE_BUCKET_TYPE *bucket, const KeyType &key, uint32_t local_depth)
+    -> bool {
+  if (local_depth >= DIRECTORY_MAX_DEPTH) {
+    return false;
+  }
+  // all entries already agree on the low local_depth bits, splitting only helps if one
+  // of them differs from the new key in a bit the directory can still reach
+  uint32_t mask = (1U << DIRECTORY_MAX_DEPTH) - 1;
+  uint32_t key_bits = Hash(key) & mask;
+  HASH_TABLE_BUCKET_TYPE *page = bucket;
+  page_id_t page_id = INVALID_PAGE_ID;
+  bool separable = false;
+  while (!separable) {
+    for (uint32_t i = 0; i < BUCKET_ARRAY_SIZE && page->IsOccupied(i); i++) {
+      if (page->IsReadable(i) && (Hash(page->KeyAt(i)) & mask) != key_bits) {
+        separable = true;
+        break;
+      }
+    }
+    page_id_t next_page_id = page->GetOverflowPageId();
+    if (page_id != INVALID_PAGE_ID) {
+      buffer_pool_manager_->UnpinPage(page_id, false);
+    }
+    if (next_page_id == INVALID_PAGE_ID) {
+      break;
+    }
+    page_id = next_page_id;
+    page = FetchBucketPage(page_id);
+  }
+  return separable;
+}
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
@@ -93,16 +269,17 @@ auto HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std
   // cout << "GetValue " << key << endl;
   table_latch_.RLock();
   HashTableDirectoryPage *directory_page = FetchDirectoryPage();
+  page_id_t directory_page_id = directory_page->GetPageId();
   page_id_t bucket_page_id = KeyToPageId(key, directory_page);
   HASH_TABLE_BUCKET_TYPE *bucket_page = FetchBucketPage(bucket_page_id);
 
   RLatchFromBucketPage(bucket_page);
-  bool res = bucket_page->GetValue(key, comparator_, result);
+  bool res = ChainGetValue(bucket_page, key, result);
   RUnLatchFromBucketPage(bucket_page);
 
-  table_latch_.RUnlock();
   buffer_pool_manager_->UnpinPage(bucket_page_id, false, nullptr);
-  buffer_pool_manager_->UnpinPage(directory_page_id_, false, nullptr);
+  buffer_pool_manager_->UnpinPage(directory_page_id, false, nullptr);
+  table_latch_.RUnlock();
   return res;
 }
 
@@ -111,108 +288,326 @@ auto HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
+  // optimistic path: if the bucket has room, or is going to grow an overflow page rather than
+  // split, only the bucket chain changes, so the directory can stay shared and inserts into
+  // different buckets run in parallel
+  table_latch_.RLock();
+  HashTableDirectoryPage *directory_page = FetchDirectoryPage();
+  page_id_t directory_page_id = directory_page->GetPageId();
+  uint32_t bucket_index = KeyToDirectoryIndex(key, directory_page);
+  page_id_t bucket_page_id = directory_page->GetBucketPageId(bucket_index);
+  HASH_TABLE_BUCKET_TYPE *bucket = FetchBucketPage(bucket_page_id);
+  WLatchFromBucketPage(bucket);
+
+  if (!ChainIsFull(bucket) || !SplitCanSeparate(bucket, key, directory_page->GetLocalDepth(bucket_index))) {
+    bool ok = ChainInsert(bucket, key, value);
+    WUnLatchFromBucketPage(bucket);
+    buffer_pool_manager_->UnpinPage(bucket_page_id, ok);
+    buffer_pool_manager_->UnpinPage(directory_page_id, false);
+    table_latch_.RUnlock();
+    return ok;
+  }
+
+  // the bucket has to be split, escalate to the exclusive directory latch
+  WUnLatchFromBucketPage(bucket);
+  buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+  buffer_pool_manager_->UnpinPage(directory_page_id, false);
+  table_latch_.RUnlock();
   return SplitInsert(transaction, key, value);
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  // cout << "Insert " << key << " , " << value << endl;
-  table_latch_.WLock();
+  // splits are serialized, but lookups and inserts into other buckets keep running on the
+  // current directory while a split is prepared on a copy of it
+  std::lock_guard<std::mutex> structure_guard(structure_latch_);
+  table_latch_.RLock();
 
-  HashTableDirectoryPage *directory_page = FetchDirectoryPage();
+  // another insert may have split the bucket meanwhile, so the decision is made again
+  bool ok = false;
+  while (true) {
+    HashTableDirectoryPage *directory_page = FetchDirectoryPage();
+    page_id_t directory_page_id = directory_page->GetPageId();
+    uint32_t bucket_index = KeyToDirectoryIndex(key, directory_page);
+    page_id_t bucket_page_id = directory_page->GetBucketPageId(bucket_index);
+    HASH_TABLE_BUCKET_TYPE *bucket = FetchBucketPage(bucket_page_id);
+    WLatchFromBucketPage(bucket);
 
-  HASH_TABLE_BUCKET_TYPE *bucket = FetchBucketPage(KeyToPageId(key, directory_page));
-  WLatchFromBucketPage(bucket);
+    if (!ChainIsFull(bucket) || !SplitCanSeparate(bucket, key, directory_page->GetLocalDepth(bucket_index))) {
+      ok = ChainInsert(bucket, key, value);
+      WUnLatchFromBucketPage(bucket);
+      buffer_pool_manager_->UnpinPage(bucket_page_id, ok);
+      buffer_pool_manager_->UnpinPage(directory_page_id, false);
+      break;
+    }
 
-  while (bucket->IsFull()) {
-    uint32_t bucket_index = KeyToDirectoryIndex(key, directory_page);
-    page_id_t bucket_page_id = KeyToPageId(key, directory_page);
-
-    int same_key_counter = 0;
-    for (uint32_t i = 0; i < BUCKET_ARRAY_SIZE; i++) {
-      KeyType key_tmp = bucket->KeyAt(i);
-      // cout << KeyToDirectoryIndex(key_tmp, directory_page) << " ";
-      if (comparator_(key, key_tmp) == 0) {
-        same_key_counter++;
+    page_id_t new_directory_page_id;
+    Page *new_directory = buffer_pool_manager_->NewPage(&new_directory_page_id, nullptr);
+    bool split = new_directory != nullptr;
+    if (split) {
+      memcpy(new_directory->GetData(), reinterpret_cast<char *>(directory_page), PAGE_SIZE);
+      auto *new_directory_page = reinterpret_cast<HashTableDirectoryPage *>(new_directory->GetData());
+      new_directory_page->SetPageId(new_directory_page_id);
+      split = SplitBucket(bucket_index, bucket, new_directory_page);
+      buffer_pool_manager_->UnpinPage(new_directory_page_id, split);
+      if (!split) {
+        buffer_pool_manager_->DeletePage(new_directory_page_id);
+      }
+    }
+    uint32_t local_depth = directory_page->GetLocalDepth(bucket_index);
+    WUnLatchFromBucketPage(bucket);
+    buffer_pool_manager_->UnpinPage(directory_page_id, false);
+    if (!split) {
+      // out of memory
+      buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+      break;
+    }
+
+    // publish the new directory. Operations on the old one hold the table latch, so the
+    // swap waits for them to finish rather than making them wait, and nobody can see the
+    // old directory afterwards. The bucket stays full until its split image entries are
+    // dropped, so inserts into it come here and wait for the structure latch.
+    table_latch_.RUnlock();
+    table_latch_.WLock();
+    directory_page_id_ = new_directory_page_id;
+    table_latch_.WUnlock();
+    table_latch_.RLock();
+    // the old directory was unpinned above and is not reachable anymore
+    buffer_pool_manager_->DeletePage(directory_page_id);
+
+    WLatchFromBucketPage(bucket);
+    DropSplitImage(bucket, local_depth);
+    WUnLatchFromBucketPage(bucket);
+    buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+  }
+
+  table_latch_.RUnlock();
+  return ok;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::SplitBucket(uint32_t bucket_index, HASH_TABLE_BUCKET_TYPE *bucket,
+                                  HashTableDirectoryPage *dir_page) -> bool {
+  page_id_t image_page_id;
+  Page *image_page = buffer_pool_manager_->NewPage(&image_page_id, nullptr);
+  if (image_page == nullptr) {
+    return false;
+  }
+  auto *image = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(image_page->GetData());
+  image->Init();
+
+  uint32_t local_depth = dir_page->GetLocalDepth(bucket_index);
+  if (local_depth == dir_page->GetGlobalDepth()) {
+    dir_page->IncrGlobalDepth();
+  }
+  // every slot that pointed at the bucket gets the deeper local depth, and the half
+  // with the new bit set points at the split image
+  uint32_t local_mask = (1U << local_depth) - 1;
+  uint32_t high_bit = 1U << local_depth;
+  for (uint32_t i = 0; i < dir_page->Size(); i++) {
+    if ((i & local_mask) == (bucket_index & local_mask)) {
+      dir_page->SetLocalDepth(i, local_depth + 1);
+      if ((i & high_bit) != 0) {
+        dir_page->SetBucketPageId(i, image_page_id);
       }
     }
+  }
 
-    if (same_key_counter == BUCKET_ARRAY_SIZE) {
-      // can never be able to insert
-      WUnLatchFromBucketPage(bucket);
-      buffer_pool_manager_->UnpinPage(KeyToPageId(key, directory_page), true);
-      buffer_pool_manager_->UnpinPage(directory_page_id_, true);
-      table_latch_.WUnlock();
-      return false;
+  // the entries are copied, the bucket keeps them for lookups on the old directory
+  std::vector<MappingType> entries;
+  CollectChain(bucket, &entries, false);
+  for (const auto &entry : entries) {
+    if ((Hash(entry.first) & high_bit) != 0) {
+      ChainInsert(image, entry.first, entry.second);
     }
+  }
 
-    // split for a bit
-    uint32_t old_depth = directory_page->GetGlobalDepth();
-    // cout << "SPLIT: for bucket" << bucket_index << ", current global depth " << old_depth << endl;
-    // cout << "current directory" << endl;
-    // decide whether we need to increase
-    if (directory_page->GetLocalDepth(bucket_index) == old_depth) {
-      //  increase the global depth
-      directory_page->IncrGlobalDepth();
-      // and set up other pages
-      for (uint32_t i = 0; i < static_cast<uint32_t>(1 << old_depth); i++) {
-        uint8_t current_depth = directory_page->GetLocalDepth(i);
-        uint32_t current_bucket = directory_page->GetBucketPageId(i);
-        directory_page->SetLocalDepth(i + static_cast<uint32_t>(1 << old_depth), current_depth);
-        directory_page->SetBucketPageId(i + static_cast<uint32_t>(1 << old_depth), current_bucket);
+  buffer_pool_manager_->UnpinPage(image_page_id, true);
+  return true;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::DropSplitImage(HASH_TABLE_BUCKET_TYPE *bucket, uint32_t local_depth) {
+  std::vector<MappingType> entries;
+  CollectChain(bucket, &entries, true);
+  bucket->Init();
+  uint32_t high_bit = 1U << local_depth;
+  for (const auto &entry : entries) {
+    if ((Hash(entry.first) & high_bit) == 0) {
+      ChainInsert(bucket, entry.first, entry.second);
+    }
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::CollectChain(HASH_TABLE_BUCKET_TYPE *bucket, std::vector<MappingType> *entries,
+                                   bool free_overflow) {
+  HASH_TABLE_BUCKET_TYPE *page = bucket;
+  page_id_t page_id = INVALID_PAGE_ID;
+  while (true) {
+    for (uint32_t i = 0; i < BUCKET_ARRAY_SIZE && page->IsOccupied(i); i++) {
+      if (page->IsReadable(i)) {
+        entries->emplace_back(page->KeyAt(i), page->ValueAt(i));
       }
     }
+    page_id_t next_page_id = page->GetOverflowPageId();
+    if (page_id != INVALID_PAGE_ID) {
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      if (free_overflow) {
+        buffer_pool_manager_->DeletePage(page_id);
+      }
+    }
+    if (next_page_id == INVALID_PAGE_ID) {
+      break;
+    }
+    page_id = next_page_id;
+    page = FetchBucketPage(page_id);
+  }
+}
 
-    // allocate a new page for new bucket, and insert it into page directory
-    uint32_t new_bucket_index = GetSplitPageIndex(bucket_index, directory_page);
-    page_id_t new_bucket_page_id;
-    Page *new_bucket_page = buffer_pool_manager_->NewPage(&new_bucket_page_id, nullptr);
-    if (new_bucket_page == nullptr) {
-      // out of memory
-      WUnLatchFromBucketPage(bucket);
-      buffer_pool_manager_->UnpinPage(KeyToPageId(key, directory_page), true);
-      buffer_pool_manager_->UnpinPage(directory_page_id_, true);
-      table_latch_.WUnlock();
-      return false;
+/*****************************************************************************
+ * BULK LOAD
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::BulkLoad(Transaction *transaction, const std::vector<MappingType> &pairs) -> bool {
+  std::unique_lock<std::mutex> structure_guard(structure_latch_);
+  table_latch_.WLock();
+  HashTableDirectoryPage *directory_page = FetchDirectoryPage();
+  page_id_t directory_page_id = directory_page->GetPageId();
+  page_id_t first_page_id = directory_page->GetBucketPageId(0);
+  HASH_TABLE_BUCKET_TYPE *first_bucket = FetchBucketPage(first_page_id);
+  if (directory_page->GetGlobalDepth() != 0 || !first_bucket->IsEmpty()) {
+    // the existing buckets would have to be merged in, fall back to plain inserts
+    buffer_pool_manager_->UnpinPage(first_page_id, false);
+    buffer_pool_manager_->UnpinPage(directory_page_id, false);
+    table_latch_.WUnlock();
+    structure_guard.unlock();
+    bool ok = true;
+    for (const auto &pair : pairs) {
+      ok = Insert(transaction, pair.first, pair.second) && ok;
     }
-    directory_page->SetBucketPageId(new_bucket_index, new_bucket_page_id);
-    auto *new_bucket = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(new_bucket_page->GetData());
-    WLatchFromBucketPage(new_bucket);
-
-    //  transfer corresponding items to new bucket
-    for (uint32_t i = 0; i < BUCKET_ARRAY_SIZE; i++) {
-      KeyType key_tmp = bucket->KeyAt(i);
-      ValueType value_tmp = bucket->ValueAt(i);
-      // cout << KeyToDirectoryIndex(key_tmp, directory_page) << " ";
-      if (KeyToDirectoryIndex(key_tmp, directory_page) == new_bucket_index) {
-        new_bucket->Insert(key_tmp, value_tmp, comparator_);
-        bucket->RemoveAt(i);
+    return ok;
+  }
+
+  std::vector<uint32_t> hashes(pairs.size());
+  for (size_t i = 0; i < pairs.size(); i++) {
+    hashes[i] = Hash(pairs[i].first);
+  }
+
+  // start with enough buckets to fill each of them about three quarters
+  uint32_t depth = 0;
+  while (depth < DIRECTORY_MAX_DEPTH && (3 * BUCKET_ARRAY_SIZE << depth) < 4 * pairs.size()) {
+    depth++;
+  }
+
+  // a partition holds the pairs whose hashes end in the prefix_'s low depth_ bits
+  struct Partition {
+    uint32_t prefix_;
+    uint32_t depth_;
+    std::vector<size_t> entries_;
+  };
+  std::vector<Partition> pending(1U << depth);
+  for (uint32_t i = 0; i < pending.size(); i++) {
+    pending[i].prefix_ = i;
+    pending[i].depth_ = depth;
+  }
+  for (size_t i = 0; i < pairs.size(); i++) {
+    pending[hashes[i] & ((1U << depth) - 1)].entries_.push_back(i);
+  }
+
+  // divide the partitions that do not fit into a bucket until they do, or until
+  // their hashes cannot be told apart any more and they have to be chained
+  std::vector<Partition> buckets;
+  uint32_t global_depth = depth;
+  uint32_t max_mask = (1U << DIRECTORY_MAX_DEPTH) - 1;
+  while (!pending.empty()) {
+    Partition partition = std::move(pending.back());
+    pending.pop_back();
+    bool separable = false;
+    if (partition.entries_.size() > BUCKET_ARRAY_SIZE && partition.depth_ < DIRECTORY_MAX_DEPTH) {
+      uint32_t first_bits = hashes[partition.entries_[0]] & max_mask;
+      for (size_t i : partition.entries_) {
+        if ((hashes[i] & max_mask) != first_bits) {
+          separable = true;
+          break;
+        }
       }
     }
-    // then update the local depth
-    directory_page->IncrLocalDepth(new_bucket_index);
-    directory_page->IncrLocalDepth(bucket_index);
+    if (!separable) {
+      buckets.push_back(std::move(partition));
+      continue;
+    }
 
-    // and unpin the page we don't need
-    if (KeyToDirectoryIndex(key, directory_page) == new_bucket_index) {
-      buffer_pool_manager_->UnpinPage(bucket_page_id, true);
-      WUnLatchFromBucketPage(bucket);
-      bucket = new_bucket;
-    } else {
-      buffer_pool_manager_->UnpinPage(new_bucket_page_id, true);
-      WUnLatchFromBucketPage(new_bucket);
+    Partition low{partition.prefix_, partition.depth_ + 1, {}};
+    Partition high{partition.prefix_ | (1U << partition.depth_), partition.depth_ + 1, {}};
+    for (size_t i : partition.entries_) {
+      ((hashes[i] >> partition.depth_) & 1 ? high : low).entries_.push_back(i);
     }
-    // cout << "After split" << endl;
-    // PrintPageDirectory();
+    global_depth = std::max(global_depth, partition.depth_ + 1);
+    pending.push_back(std::move(low));
+    pending.push_back(std::move(high));
   }
-  bool ok = bucket->Insert(key, value, comparator_);
 
-  WUnLatchFromBucketPage(bucket);
-  buffer_pool_manager_->UnpinPage(KeyToPageId(key, directory_page), true);
-  buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+  // write every bucket page and its overflow pages once, the empty first bucket is reused
+  std::vector<page_id_t> bucket_page_ids(buckets.size());
+  std::vector<page_id_t> new_page_ids;
+  bool ok = true;
+  for (size_t b = 0; b < buckets.size() && ok; b++) {
+    page_id_t page_id = first_page_id;
+    HASH_TABLE_BUCKET_TYPE *page = first_bucket;
+    if (b != 0) {
+      Page *new_page = buffer_pool_manager_->NewPage(&page_id, nullptr);
+      if (new_page == nullptr) {
+        ok = false;
+        break;
+      }
+      new_page_ids.push_back(page_id);
+      page = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(new_page->GetData());
+    }
+    page->Init();
+    bucket_page_ids[b] = page_id;
+
+    for (size_t i : buckets[b].entries_) {
+      if (page->IsFull()) {
+        page_id_t overflow_page_id;
+        Page *overflow_page = buffer_pool_manager_->NewPage(&overflow_page_id, nullptr);
+        if (overflow_page == nullptr) {
+          ok = false;
+          break;
+        }
+        new_page_ids.push_back(overflow_page_id);
+        page->SetOverflowPageId(overflow_page_id);
+        buffer_pool_manager_->UnpinPage(page_id, true);
+        page_id = overflow_page_id;
+        page = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(overflow_page->GetData());
+        page->Init();
+      }
+      page->Insert(pairs[i].first, pairs[i].second, comparator_);
+    }
+    buffer_pool_manager_->UnpinPage(page_id, true);
+  }
 
-  table_latch_.WUnlock();
+  if (ok) {
+    while (directory_page->GetGlobalDepth() < global_depth) {
+      directory_page->IncrGlobalDepth();
+    }
+    for (size_t b = 0; b < buckets.size(); b++) {
+      for (uint32_t i = buckets[b].prefix_; i < directory_page->Size(); i += 1U << buckets[b].depth_) {
+        directory_page->SetBucketPageId(i, bucket_page_ids[b]);
+        directory_page->SetLocalDepth(i, buckets[b].depth_);
+      }
+    }
+  } else {
+    // out of memory, leave the table empty
+    for (page_id_t page_id : new_page_ids) {
+      buffer_pool_manager_->DeletePage(page_id);
+    }
+    FetchBucketPage(first_page_id)->Init();
+    buffer_pool_manager_->UnpinPage(first_page_id, true);
+  }
 
+  buffer_pool_manager_->UnpinPage(directory_page_id, ok);
+  table_latch_.WUnlock();
   return ok;
 }
 
@@ -234,9 +629,12 @@ void HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key, const
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_TYPE::MergeInner(Transaction *transaction, const KeyType &key, const ValueType &value) {
+  // a split in progress relies on the entries of its bucket staying put
+  std::lock_guard<std::mutex> structure_guard(structure_latch_);
   table_latch_.WLock();
 
   HashTableDirectoryPage *directory_page = FetchDirectoryPage();
+  page_id_t directory_page_id = directory_page->GetPageId();
   uint32_t bucket_id = KeyToDirectoryIndex(key, directory_page);
   // cout << "REMOVE " << key << " , " << value << " from " << bucket_id << endl;
 
@@ -244,11 +642,11 @@ bool HASH_TABLE_TYPE::MergeInner(Transaction *transaction, const KeyType &key, c
   HASH_TABLE_BUCKET_TYPE *bucket = FetchBucketPage(bucket_page_id);
   WLatchFromBucketPage(bucket);
 
-  bool ok = bucket->Remove(key, value, comparator_);
+  bool ok = ChainRemove(bucket, key, value);
   if (!ok) {
     WUnLatchFromBucketPage(bucket);
     buffer_pool_manager_->UnpinPage(bucket_page_id, true);
-    buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+    buffer_pool_manager_->UnpinPage(directory_page_id, true);
     table_latch_.WUnlock();
     return false;
   }
@@ -340,7 +738,7 @@ bool HASH_TABLE_TYPE::MergeInner(Transaction *transaction, const KeyType &key, c
 
   WUnLatchFromBucketPage(bucket);
   buffer_pool_manager_->UnpinPage(bucket_page_id, true);
-  buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+  buffer_pool_manager_->UnpinPage(directory_page_id, true);
   table_latch_.WUnlock();
 
   return ok;
@@ -391,6 +789,19 @@ void HASH_TABLE_TYPE::PrintPageDirectory() {
   // assert(buffer_pool_manager_->UnpinPage(directory_page_id_, false, nullptr));
 }
 
+/*****************************************************************************
+ * ITERATION
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::Begin() -> ExtendibleHashTableIterator<KeyType, ValueType, KeyComparator> {
+  return ExtendibleHashTableIterator<KeyType, ValueType, KeyComparator>(this);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::End() -> ExtendibleHashTableIterator<KeyType, ValueType, KeyComparator> {
+  return ExtendibleHashTableIterator<KeyType, ValueType, KeyComparator>(nullptr);
+}
+
 /*****************************************************************************
  * GETGLOBALDEPTH - DO NOT TOUCH
  *****************************************************************************/
@@ -0,0 +1,125 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// extendible_hash_table_iterator.cpp
+//
+// Identification: src/container/hash/extendible_hash_table_iterator.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "container/hash/extendible_hash_table_iterator.h"
+
+#include "common/rid.h"
+#include "container/hash/extendible_hash_table.h"
+
+namespace bustub {
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+HASH_TABLE_ITERATOR_TYPE::ExtendibleHashTableIterator(ExtendibleHashTable<KeyType, ValueType, KeyComparator> *table)
+    : table_(table) {
+  if (table_ != nullptr) {
+    LoadNextBucket();
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+HASH_TABLE_ITERATOR_TYPE::ExtendibleHashTableIterator(ExtendibleHashTableIterator &&other) noexcept
+    : table_(other.table_),
+      next_slot_(other.next_slot_),
+      entries_(std::move(other.entries_)),
+      pos_(other.pos_) {
+  other.table_ = nullptr;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_ITERATOR_TYPE::IsEnd() const -> bool {
+  return table_ == nullptr;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_ITERATOR_TYPE::operator*() -> const MappingType & {
+  return entries_[pos_];
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_ITERATOR_TYPE::operator++() -> ExtendibleHashTableIterator & {
+  if (++pos_ == entries_.size()) {
+    LoadNextBucket();
+  }
+  return *this;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_ITERATOR_TYPE::operator==(const ExtendibleHashTableIterator &itr) const -> bool {
+  if (IsEnd() || itr.IsEnd()) {
+    return IsEnd() && itr.IsEnd();
+  }
+  return table_ == itr.table_ && next_slot_ == itr.next_slot_ && pos_ == itr.pos_;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_ITERATOR_TYPE::LoadNextBucket() {
+  BufferPoolManager *buffer_pool_manager = table_->buffer_pool_manager_;
+  entries_.clear();
+  pos_ = 0;
+  while (entries_.empty()) {
+    table_->table_latch_.RLock();
+    HashTableDirectoryPage *directory_page = table_->FetchDirectoryPage();
+    page_id_t directory_page_id = directory_page->GetPageId();
+    // a slot past the local depth of its bucket shares the bucket with a lower slot
+    auto next_bucket_slot = [directory_page](uint32_t slot) {
+      while (slot < directory_page->Size() && slot >= (1U << directory_page->GetLocalDepth(slot))) {
+        slot++;
+      }
+      return slot;
+    };
+    next_slot_ = next_bucket_slot(next_slot_);
+    if (next_slot_ >= directory_page->Size()) {
+      buffer_pool_manager->UnpinPage(directory_page_id, false);
+      table_->table_latch_.RUnlock();
+      table_ = nullptr;
+      return;
+    }
+    page_id_t bucket_page_id = directory_page->GetBucketPageId(next_slot_++);
+    buffer_pool_manager->UnpinPage(directory_page_id, false);
+
+    // the bucket is read while the table latch keeps it in the directory
+    Page *page = buffer_pool_manager->FetchPage(bucket_page_id, nullptr);
+    auto *bucket = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData());
+    page->RLatch();
+    auto *chain_page = bucket;
+    page_id_t chain_page_id = INVALID_PAGE_ID;
+    while (true) {
+      for (uint32_t i = 0; i < BUCKET_ARRAY_SIZE && chain_page->IsOccupied(i); i++) {
+        if (chain_page->IsReadable(i)) {
+          entries_.emplace_back(chain_page->KeyAt(i), chain_page->ValueAt(i));
+        }
+      }
+      page_id_t next_page_id = chain_page->GetOverflowPageId();
+      if (chain_page_id != INVALID_PAGE_ID) {
+        buffer_pool_manager->UnpinPage(chain_page_id, false);
+      }
+      if (next_page_id == INVALID_PAGE_ID) {
+        break;
+      }
+      chain_page_id = next_page_id;
+      chain_page = table_->FetchBucketPage(chain_page_id);
+    }
+    page->RUnlatch();
+    buffer_pool_manager->UnpinPage(bucket_page_id, false);
+    table_->table_latch_.RUnlock();
+  }
+}
+
+template class ExtendibleHashTableIterator<int, int, IntComparator>;
+
+template class ExtendibleHashTableIterator<GenericKey<4>, RID, GenericComparator<4>>;
+template class ExtendibleHashTableIterator<GenericKey<8>, RID, GenericComparator<8>>;
+template class ExtendibleHashTableIterator<GenericKey<16>, RID, GenericComparator<16>>;
+template class ExtendibleHashTableIterator<GenericKey<32>, RID, GenericComparator<32>>;
+template class ExtendibleHashTableIterator<GenericKey<64>, RID, GenericComparator<64>>;
+
+}  // namespace bustub
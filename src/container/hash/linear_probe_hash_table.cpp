@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <utility>
@@ -17,6 +18,7 @@
 
 #include "common/exception.h"
 #include "common/logger.h"
+#include "common/macros.h"
 #include "common/rid.h"
 #include "container/hash/linear_probe_hash_table.h"
 
@@ -26,21 +28,248 @@ template <typename KeyType, typename ValueType, typename KeyComparator>
 HASH_TABLE_TYPE::LinearProbeHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
                                       const KeyComparator &comparator, size_t num_buckets,
                                       HashFunction<KeyType> hash_fn)
-    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {}
+    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {
+  header_page_id_ = CreateTable(std::max<size_t>(num_buckets, 1));
+  if (header_page_id_ == INVALID_PAGE_ID) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate the pages of the hash table");
+  }
+}
+
+/*****************************************************************************
+ * HELPERS
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::CreateTable(size_t num_buckets) -> page_id_t {
+  page_id_t header_page_id;
+  Page *page = buffer_pool_manager_->NewPage(&header_page_id, nullptr);
+  if (page == nullptr) {
+    return INVALID_PAGE_ID;
+  }
+  auto *header = reinterpret_cast<HashTableHeaderPage *>(page->GetData());
+  header->SetPageId(header_page_id);
+  header->SetSize(num_buckets);
+  for (size_t i = 0; i * BLOCK_ARRAY_SIZE < num_buckets; i++) {
+    page_id_t block_page_id;
+    if (buffer_pool_manager_->NewPage(&block_page_id, nullptr) == nullptr) {
+      // give back the blocks allocated so far
+      buffer_pool_manager_->UnpinPage(header_page_id, true);
+      DeleteTable(header_page_id);
+      return INVALID_PAGE_ID;
+    }
+    header->AddBlockPageId(block_page_id);
+    buffer_pool_manager_->UnpinPage(block_page_id, true);
+  }
+  buffer_pool_manager_->UnpinPage(header_page_id, true);
+  return header_page_id;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::DeleteTable(page_id_t header_page_id) {
+  HashTableHeaderPage *header = FetchHeaderPage(header_page_id);
+  for (size_t i = 0; i < header->NumBlocks(); i++) {
+    buffer_pool_manager_->DeletePage(header->GetBlockPageId(i));
+  }
+  buffer_pool_manager_->UnpinPage(header_page_id, false);
+  buffer_pool_manager_->DeletePage(header_page_id);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::FetchHeaderPage(page_id_t header_page_id) -> HashTableHeaderPage * {
+  Page *page = buffer_pool_manager_->FetchPage(header_page_id, nullptr);
+  return reinterpret_cast<HashTableHeaderPage *>(page->GetData());
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename Visitor>
+void HASH_TABLE_TYPE::Probe(HashTableHeaderPage *header, size_t slot, bool exclusive, Visitor &&visit) {
+  size_t num_slots = header->GetSize();
+  size_t probed = 0;
+  while (probed < num_slots) {
+    size_t block_index = slot / BLOCK_ARRAY_SIZE;
+    page_id_t block_page_id = header->GetBlockPageId(block_index);
+    Page *page = buffer_pool_manager_->FetchPage(block_page_id, nullptr);
+    if (exclusive) {
+      page->WLatch();
+    } else {
+      page->RLatch();
+    }
+    auto *block = reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(page->GetData());
+
+    size_t block_end = std::min((block_index + 1) * BLOCK_ARRAY_SIZE, num_slots);
+    bool dirty = false;
+    bool stop = false;
+    for (; slot < block_end && probed < num_slots && !stop; slot++, probed++) {
+      slot_offset_t offset = slot % BLOCK_ARRAY_SIZE;
+      // a slot that was never occupied ends the probe sequence
+      bool end = !block->IsOccupied(offset);
+      stop = visit(block, offset, &dirty) || end;
+    }
+
+    if (exclusive) {
+      page->WUnlatch();
+    } else {
+      page->RUnlatch();
+    }
+    buffer_pool_manager_->UnpinPage(block_page_id, dirty, nullptr);
+    if (stop) {
+      return;
+    }
+    if (slot == num_slots) {
+      slot = 0;
+    }
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::TableGetValue(HashTableHeaderPage *header, const KeyType &key, size_t hash,
+                                    std::vector<ValueType> *result) -> bool {
+  bool found = false;
+  Probe(header, hash % header->GetSize(), false, [&](HASH_TABLE_BLOCK_TYPE *block, slot_offset_t offset, bool *) {
+    if (block->IsReadable(offset) && comparator_(key, block->KeyAt(offset)) == 0) {
+      result->push_back(block->ValueAt(offset));
+      found = true;
+    }
+    return false;
+  });
+  return found;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::TableContains(HashTableHeaderPage *header, const KeyType &key, const ValueType &value,
+                                    size_t hash, size_t *free_slot) -> bool {
+  size_t num_slots = header->GetSize();
+  size_t slot = hash % num_slots;
+  bool found = false;
+  bool has_free_slot = false;
+  Probe(header, slot, false, [&](HASH_TABLE_BLOCK_TYPE *block, slot_offset_t offset, bool *) {
+    if (!block->IsReadable(offset)) {
+      if (!has_free_slot) {
+        has_free_slot = true;
+        *free_slot = slot;
+      }
+    } else if (comparator_(key, block->KeyAt(offset)) == 0 && block->ValueAt(offset) == value) {
+      found = true;
+    }
+    slot = (slot + 1) % num_slots;
+    return found;
+  });
+  if (!has_free_slot) {
+    *free_slot = num_slots;
+  }
+  return found;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::TableInsert(HashTableHeaderPage *header, const KeyType &key, const ValueType &value,
+                                  size_t slot) -> bool {
+  bool inserted = false;
+  Probe(header, slot, true, [&](HASH_TABLE_BLOCK_TYPE *block, slot_offset_t offset, bool *dirty) {
+    // the slot may have been taken since it was seen free, then the next one is tried
+    inserted = block->Insert(offset, key, value);
+    *dirty = *dirty || inserted;
+    return inserted;
+  });
+  return inserted;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::TableRemove(HashTableHeaderPage *header, const KeyType &key, const ValueType &value,
+                                  size_t hash) -> bool {
+  bool removed = false;
+  Probe(header, hash % header->GetSize(), true, [&](HASH_TABLE_BLOCK_TYPE *block, slot_offset_t offset, bool *dirty) {
+    if (block->IsReadable(offset) && comparator_(key, block->KeyAt(offset)) == 0 && block->ValueAt(offset) == value) {
+      block->Remove(offset);
+      removed = true;
+      *dirty = true;
+    }
+    return removed;
+  });
+  return removed;
+}
 
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) -> bool {
-  return false;
+  size_t hash = hash_fn_.GetHash(key);
+  table_latch_.RLock();
+  bool found = false;
+  if (old_header_page_id_ != INVALID_PAGE_ID) {
+    // a pair being migrated is put into the new table before it leaves the old
+    // one, so reading the old table first never misses it but may see it twice
+    HashTableHeaderPage *old_header = FetchHeaderPage(old_header_page_id_);
+    found = TableGetValue(old_header, key, hash, result);
+    buffer_pool_manager_->UnpinPage(old_header_page_id_, false);
+  }
+  size_t num_old_values = result->size();
+  std::vector<ValueType> values;
+  HashTableHeaderPage *header = FetchHeaderPage(header_page_id_);
+  found = TableGetValue(header, key, hash, &values) || found;
+  buffer_pool_manager_->UnpinPage(header_page_id_, false);
+  table_latch_.RUnlock();
+
+  for (const auto &value : values) {
+    if (num_old_values == 0 || std::find(result->begin(), result->end(), value) == result->end()) {
+      result->push_back(value);
+    }
+  }
+  return found;
 }
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  size_t hash = hash_fn_.GetHash(key);
+  while (true) {
+    table_latch_.RLock();
+    bool duplicate = false;
+    bool inserted = false;
+    size_t num_slots;
+    {
+      std::lock_guard<std::mutex> guard(KeyLatch(hash));
+      size_t free_slot;
+      if (old_header_page_id_ != INVALID_PAGE_ID) {
+        HashTableHeaderPage *old_header = FetchHeaderPage(old_header_page_id_);
+        duplicate = TableContains(old_header, key, value, hash, &free_slot);
+        buffer_pool_manager_->UnpinPage(old_header_page_id_, false);
+      }
+      HashTableHeaderPage *header = FetchHeaderPage(header_page_id_);
+      num_slots = header->GetSize();
+      duplicate = duplicate || TableContains(header, key, value, hash, &free_slot);
+      if (!duplicate && free_slot < num_slots) {
+        inserted = TableInsert(header, key, value, free_slot);
+      }
+      buffer_pool_manager_->UnpinPage(header_page_id_, false);
+    }
+    bool resizing = old_header_page_id_ != INVALID_PAGE_ID;
+    bool migrated_last = resizing && MigrateBlock();
+    table_latch_.RUnlock();
+    if (migrated_last) {
+      FinishResize();
+    }
+
+    if (duplicate) {
+      return false;
+    }
+    if (inserted) {
+      // grow once the table is three quarters full. The count includes the pairs still waiting
+      // in the old table, so a migration in progress always finds room in the current one.
+      // If no bigger table can be allocated, the next insert tries again.
+      if (4 * ++num_pairs_ >= 3 * num_slots) {
+        Resize(num_slots);
+      }
+      return true;
+    }
+    // the table is full, grow it right away and try again
+    if (!resizing && num_slots >= HashTableHeaderPage::MaxNumBlocks() * BLOCK_ARRAY_SIZE) {
+      return false;
+    }
+    if (!Resize(num_slots)) {
+      return false;
+    }
+  }
 }
 
 /*****************************************************************************
@@ -48,21 +277,139 @@ auto HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  size_t hash = hash_fn_.GetHash(key);
+  table_latch_.RLock();
+  bool removed = false;
+  {
+    std::lock_guard<std::mutex> guard(KeyLatch(hash));
+    if (old_header_page_id_ != INVALID_PAGE_ID) {
+      HashTableHeaderPage *old_header = FetchHeaderPage(old_header_page_id_);
+      removed = TableRemove(old_header, key, value, hash);
+      buffer_pool_manager_->UnpinPage(old_header_page_id_, false);
+    }
+    if (!removed) {
+      HashTableHeaderPage *header = FetchHeaderPage(header_page_id_);
+      removed = TableRemove(header, key, value, hash);
+      buffer_pool_manager_->UnpinPage(header_page_id_, false);
+    }
+  }
+  if (removed) {
+    num_pairs_--;
+  }
+  bool migrated_last = old_header_page_id_ != INVALID_PAGE_ID && MigrateBlock();
+  table_latch_.RUnlock();
+  if (migrated_last) {
+    FinishResize();
+  }
+  return removed;
 }
 
 /*****************************************************************************
  * RESIZE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_TYPE::Resize(size_t initial_size) {}
+auto HASH_TABLE_TYPE::Resize(size_t initial_size) -> bool {
+  table_latch_.WLock();
+  // a table can only be migrated into one bigger table at a time. The inserts
+  // and removes finish the migration in progress block by block, and grow the
+  // table again afterwards if it still needs it.
+  if (old_header_page_id_ != INVALID_PAGE_ID) {
+    table_latch_.WUnlock();
+    return true;
+  }
+
+  HashTableHeaderPage *header = FetchHeaderPage(header_page_id_);
+  size_t num_slots = header->GetSize();
+  size_t num_blocks = header->NumBlocks();
+  buffer_pool_manager_->UnpinPage(header_page_id_, false);
+  size_t new_num_slots = std::min(2 * initial_size, HashTableHeaderPage::MaxNumBlocks() * BLOCK_ARRAY_SIZE);
+  if (new_num_slots <= num_slots) {
+    // somebody else has grown the table already
+    table_latch_.WUnlock();
+    return true;
+  }
+
+  page_id_t new_header_page_id = CreateTable(new_num_slots);
+  if (new_header_page_id == INVALID_PAGE_ID) {
+    table_latch_.WUnlock();
+    return false;
+  }
+  old_header_page_id_ = header_page_id_;
+  old_num_blocks_ = num_blocks;
+  next_migrate_block_ = 0;
+  migrated_blocks_ = 0;
+  header_page_id_ = new_header_page_id;
+  table_latch_.WUnlock();
+  return true;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::MigrateBlock() -> bool {
+  size_t block_index = next_migrate_block_++;
+  if (block_index >= old_num_blocks_) {
+    return false;
+  }
+
+  HashTableHeaderPage *old_header = FetchHeaderPage(old_header_page_id_);
+  HashTableHeaderPage *header = FetchHeaderPage(header_page_id_);
+  size_t num_slots = header->GetSize();
+  size_t block_size = std::min(BLOCK_ARRAY_SIZE, old_header->GetSize() - block_index * BLOCK_ARRAY_SIZE);
+  page_id_t block_page_id = old_header->GetBlockPageId(block_index);
+  Page *page = buffer_pool_manager_->FetchPage(block_page_id, nullptr);
+  auto *block = reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(page->GetData());
+
+  for (slot_offset_t offset = 0; offset < block_size; offset++) {
+    page->RLatch();
+    bool readable = block->IsReadable(offset);
+    KeyType key = block->KeyAt(offset);
+    ValueType value = block->ValueAt(offset);
+    page->RUnlatch();
+    if (!readable) {
+      continue;
+    }
+
+    // no pair can appear in the old table any more, so under the key latch the
+    // pair is either still here or has been removed by a concurrent Remove
+    size_t hash = hash_fn_.GetHash(key);
+    std::lock_guard<std::mutex> guard(KeyLatch(hash));
+    page->WLatch();
+    if (block->IsReadable(offset)) {
+      // nobody holds a block latch while waiting for another one, so holding the
+      // old block across the insert cannot deadlock
+      bool inserted = TableInsert(header, key, value, hash % num_slots);
+      BUSTUB_ASSERT(inserted, "the new table holds more slots than the table has pairs");
+      block->Remove(offset);
+    }
+    page->WUnlatch();
+  }
+
+  buffer_pool_manager_->UnpinPage(block_page_id, true);
+  buffer_pool_manager_->UnpinPage(header_page_id_, false);
+  buffer_pool_manager_->UnpinPage(old_header_page_id_, false);
+  return ++migrated_blocks_ == old_num_blocks_;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::FinishResize() {
+  table_latch_.WLock();
+  if (old_header_page_id_ != INVALID_PAGE_ID && migrated_blocks_ == old_num_blocks_) {
+    DeleteTable(old_header_page_id_);
+    old_header_page_id_ = INVALID_PAGE_ID;
+  }
+  table_latch_.WUnlock();
+}
 
 /*****************************************************************************
  * GETSIZE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::GetSize() -> size_t {
-  return 0;
+  table_latch_.RLock();
+  HashTableHeaderPage *header = FetchHeaderPage(header_page_id_);
+  size_t size = header->GetSize();
+  buffer_pool_manager_->UnpinPage(header_page_id_, false);
+  table_latch_.RUnlock();
+  return size;
 }
 
 template class LinearProbeHashTable<int, int, IntComparator>;
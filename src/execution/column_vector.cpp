@@ -0,0 +1,148 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// column_vector.cpp
+//
+// Identification: src/execution/column_vector.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstring>
+
+#include "common/macros.h"
+#include "execution/column_vector.h"
+#include "type/limits.h"
+#include "type/type.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+void ColumnVector::Reset(TypeId type) {
+  type_ = type;
+  width_ = type == TypeId::VARCHAR || type == TypeId::INVALID ? 0 : static_cast<uint32_t>(Type::GetTypeSize(type));
+  Clear();
+}
+
+void ColumnVector::Clear() {
+  size_ = 0;
+  has_null_ = false;
+  data_.clear();
+  offsets_.assign(1, 0);
+  nulls_.clear();
+}
+
+void ColumnVector::Append(const Tuple &tuple, const Schema *schema, uint32_t col_idx) {
+  const Column &column = schema->GetColumn(col_idx);
+  BUSTUB_ASSERT(column.GetType() == type_, "column type mismatch");
+  const char *storage = tuple.GetData() + column.GetOffset();
+  if (!column.IsInlined()) {
+    // the column holds the offset of the value in the tuple
+    storage = tuple.GetData() + *reinterpret_cast<const uint32_t *>(storage);
+  }
+  AppendSerialized(storage);
+}
+
+void ColumnVector::Append(const Value &value) {
+  BUSTUB_ASSERT(value.GetTypeId() == type_, "value type mismatch");
+  if (value.IsNull()) {
+    AppendNull();
+    return;
+  }
+  if (type_ == TypeId::VARCHAR) {
+    uint32_t len = value.GetLength();
+    std::vector<char> storage(sizeof(uint32_t) + len);
+    memcpy(storage.data(), &len, sizeof(uint32_t));
+    memcpy(storage.data() + sizeof(uint32_t), value.GetData(), len);
+    AppendSerialized(storage.data());
+    return;
+  }
+  char storage[sizeof(uint64_t)];
+  value.SerializeTo(storage);
+  AppendSerialized(storage);
+}
+
+void ColumnVector::AppendNull() {
+  if (type_ == TypeId::VARCHAR) {
+    uint32_t len = BUSTUB_VALUE_NULL;
+    char storage[sizeof(uint32_t)];
+    memcpy(storage, &len, sizeof(uint32_t));
+    AppendSerialized(storage);
+    return;
+  }
+  Value null = type_ == TypeId::TIMESTAMP ? ValueFactory::GetTimestampValue(static_cast<int64_t>(BUSTUB_TIMESTAMP_NULL))
+                                          : ValueFactory::GetNullValueByType(type_);
+  char storage[sizeof(uint64_t)];
+  null.SerializeTo(storage);
+  AppendSerialized(storage);
+}
+
+void ColumnVector::AppendSerialized(const char *storage) {
+  size_t row = size_++;
+  if (row % 64 == 0) {
+    nulls_.push_back(0);
+  }
+
+  if (type_ == TypeId::VARCHAR) {
+    uint32_t len;
+    memcpy(&len, storage, sizeof(uint32_t));
+    if (len == BUSTUB_VALUE_NULL) {
+      // a NULL is stored as the empty string
+      data_.push_back('\0');
+      SetNull(row);
+    } else {
+      data_.insert(data_.end(), storage + sizeof(uint32_t), storage + sizeof(uint32_t) + len);
+    }
+    offsets_.push_back(static_cast<uint32_t>(data_.size()));
+    return;
+  }
+
+  // NULL is a reserved value of every fixed size type
+  data_.insert(data_.end(), storage, storage + width_);
+  bool is_null = false;
+  switch (type_) {
+    case TypeId::BOOLEAN:
+    case TypeId::TINYINT:
+      is_null = *reinterpret_cast<const int8_t *>(storage) == BUSTUB_INT8_NULL;
+      break;
+    case TypeId::SMALLINT:
+      is_null = *reinterpret_cast<const int16_t *>(storage) == BUSTUB_INT16_NULL;
+      break;
+    case TypeId::INTEGER:
+      is_null = *reinterpret_cast<const int32_t *>(storage) == BUSTUB_INT32_NULL;
+      break;
+    case TypeId::BIGINT:
+      is_null = *reinterpret_cast<const int64_t *>(storage) == BUSTUB_INT64_NULL;
+      break;
+    case TypeId::DECIMAL:
+      is_null = *reinterpret_cast<const double *>(storage) == BUSTUB_DECIMAL_NULL;
+      break;
+    case TypeId::TIMESTAMP:
+      is_null = *reinterpret_cast<const uint64_t *>(storage) == BUSTUB_TIMESTAMP_NULL;
+      break;
+    default:
+      BUSTUB_ASSERT(false, "unsupported column type");
+  }
+  if (is_null) {
+    SetNull(row);
+  }
+}
+
+void ColumnVector::SetNull(size_t i) {
+  nulls_[i / 64] |= uint64_t{1} << (i % 64);
+  has_null_ = true;
+}
+
+auto ColumnVector::GetValue(size_t i) const -> Value {
+  if (type_ != TypeId::VARCHAR) {
+    return Type::GetInstance(type_)->DeserializeFrom(data_.data() + i * width_);
+  }
+  if (IsNull(i)) {
+    return ValueFactory::GetNullValueByType(TypeId::VARCHAR);
+  }
+  return ValueFactory::GetVarcharValue(data_.data() + offsets_[i], offsets_[i + 1] - offsets_[i], true);
+}
+
+}  // namespace bustub
@@ -23,40 +23,67 @@ void HashJoinExecutor::Init() {
   left_child_->Init();
   right_child_->Init();
   // construct the hashtable
-  Tuple left_tuple;
-  RID left_rid;
+  TupleBatch left_batch;
   hash_table_.clear();
-  buffer_.clear();
-  while (left_child_->Next(&left_tuple, &left_rid)) {
-    Value left_join_key = plan_->LeftJoinKeyExpression()->Evaluate(&left_tuple, plan_->GetLeftPlan()->OutputSchema());
-    hash_table_[{left_join_key}].push_back(left_tuple);
+  while (left_child_->NextBatch(&left_batch)) {
+    for (size_t i = 0; i < left_batch.Size(); i++) {
+      Value left_join_key =
+          plan_->LeftJoinKeyExpression()->Evaluate(&left_batch.GetTuple(i), plan_->GetLeftPlan()->OutputSchema());
+      hash_table_[{left_join_key}].push_back(std::move(left_batch.GetTuple(i)));
+    }
   }
+  right_batch_.Clear();
+  right_pos_ = 0;
+  matches_ = nullptr;
+  match_pos_ = 0;
 }
 
 auto HashJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool {
-  if (!buffer_.empty()) {
-    *tuple = JoinTuple(buffer_[buffer_.size() - 1], right_tuple_);
-    buffer_.pop_back();
-    return true;
+  if (!NextMatch()) {
+    return false;
+  }
+  *tuple = JoinTuple((*matches_)[match_pos_++], right_batch_.GetTuple(right_pos_));
+  return true;
+}
+
+auto HashJoinExecutor::NextBatch(TupleBatch *batch) -> bool {
+  batch->Clear();
+  while (!batch->IsFull() && NextMatch()) {
+    batch->Append(JoinTuple((*matches_)[match_pos_++], right_batch_.GetTuple(right_pos_)), RID{});
   }
-  RID tmp;
-  while (right_child_->Next(&right_tuple_, &tmp)) {
-    Value right_join_key =
-        plan_->RightJoinKeyExpression()->Evaluate(&right_tuple_, plan_->GetRightPlan()->OutputSchema());
-    if (hash_table_.find({right_join_key}) == hash_table_.end()) {
+  return !batch->IsEmpty();
+}
+
+auto HashJoinExecutor::NextMatch() -> bool {
+  while (matches_ == nullptr || match_pos_ == matches_->size()) {
+    if (matches_ != nullptr) {
+      // all left matches of the current right tuple are joined
+      matches_ = nullptr;
+      right_pos_++;
+    }
+    if (right_pos_ == right_batch_.Size()) {
+      right_pos_ = 0;
+      if (!right_child_->NextBatch(&right_batch_)) {
+        return false;
+      }
+    }
+    Value right_join_key = plan_->RightJoinKeyExpression()->Evaluate(&right_batch_.GetTuple(right_pos_),
+                                                                     plan_->GetRightPlan()->OutputSchema());
+    auto bucket = hash_table_.find({right_join_key});
+    if (bucket == hash_table_.end()) {
+      right_pos_++;
       continue;
     }
-    buffer_ = hash_table_[{right_join_key}];
-    *tuple = JoinTuple(buffer_[buffer_.size() - 1], right_tuple_);
-    buffer_.pop_back();
-    return true;
+    matches_ = &bucket->second;
+    match_pos_ = 0;
   }
-  return false;
+  return true;
 }
 
 Tuple HashJoinExecutor::JoinTuple(const Tuple &left, const Tuple &right) {
   vector<Value> values;
   const Schema *output_schema = plan_->OutputSchema();
+  values.reserve(output_schema->GetColumnCount());
   for (uint32_t i = 0; i < output_schema->GetColumnCount(); i++) {
     const auto &column = output_schema->GetColumn(i);
     Value v = column.GetExpr()->EvaluateJoin(&left, plan_->GetLeftPlan()->OutputSchema(), &right,
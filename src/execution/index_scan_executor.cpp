@@ -9,14 +9,213 @@
 // Copyright (c) 2015-19, Carnegie Mellon University Database Group
 //
 //===----------------------------------------------------------------------===//
+#include <algorithm>
+
+#include "common/exception.h"
 #include "execution/executors/index_scan_executor.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "type/value_factory.h"
 
 namespace bustub {
+
+/*
+ * Whether an expression reads only the columns set in {columns}.
+ */
+static auto ReadsOnly(const AbstractExpression *expr, const std::vector<bool> &columns) -> bool {
+  if (expr == nullptr) {
+    return true;
+  }
+  if (const auto *column = dynamic_cast<const ColumnValueExpression *>(expr); column != nullptr) {
+    return column->GetColIdx() < columns.size() && columns[column->GetColIdx()];
+  }
+  const auto &children = expr->GetChildren();
+  return std::all_of(children.begin(), children.end(),
+                     [&columns](const AbstractExpression *child) { return ReadsOnly(child, columns); });
+}
+
 IndexScanExecutor::IndexScanExecutor(ExecutorContext *exec_ctx, const IndexScanPlanNode *plan)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx), plan_(plan) {
+  Catalog *catalog = exec_ctx_->GetCatalog();
+  index_info_ = catalog->GetIndex(plan_->GetIndexOid());
+  table_info_ = catalog->GetTable(index_info_->table_name_);
+
+  // the scan is index-only if every column it reads is a key column. A varchar may be cut off in
+  // the index key, so keys with a varchar are always checked on the table heap
+  const Schema &schema = table_info_->schema_;
+  std::vector<bool> key_columns(schema.GetColumnCount(), false);
+  for (uint32_t column_idx : index_info_->index_->GetKeyAttrs()) {
+    key_columns[column_idx] = true;
+  }
+  const auto &output_columns = plan_->OutputSchema()->GetColumns();
+  index_only_ = index_info_->index_->GetKeySchema()->IsInlined() && ReadsOnly(plan_->GetPredicate(), key_columns) &&
+                std::all_of(output_columns.begin(), output_columns.end(), [&key_columns](const Column &column) {
+                  return column.GetExpr() != nullptr && ReadsOnly(column.GetExpr(), key_columns);
+                });
+  if (index_only_) {
+    for (const Column &column : schema.GetColumns()) {
+      row_values_.push_back(column.GetType() == TypeId::TIMESTAMP ? ValueFactory::GetTimestampValue(0)
+                                                                  : ValueFactory::GetZeroValueByType(column.GetType()));
+    }
+  }
+  DeriveBounds();
+}
+
+void IndexScanExecutor::DeriveBounds() {
+  const auto *comparison = dynamic_cast<const ComparisonExpression *>(plan_->GetPredicate());
+  if (comparison == nullptr) {
+    return;
+  }
+  // the comparison is read as (first key column) op (constant)
+  uint32_t key_column_idx = index_info_->index_->GetKeyAttrs()[0];
+  const auto *column = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(0));
+  const auto *constant = dynamic_cast<const ConstantValueExpression *>(comparison->GetChildAt(1));
+  bool swapped = column == nullptr;
+  if (swapped) {
+    column = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(1));
+    constant = dynamic_cast<const ConstantValueExpression *>(comparison->GetChildAt(0));
+  }
+  if (column == nullptr || constant == nullptr || column->GetColIdx() != key_column_idx) {
+    return;
+  }
+  Value value = constant->Evaluate(nullptr, nullptr);
+
+  // strict comparisons are bounded inclusively, the predicate drops the key itself
+  switch (comparison->GetComparisonType()) {
+    case ComparisonType::Equal:
+      if (MakeBound(value, &lower_)) {
+        upper_ = lower_;
+      }
+      break;
+    case ComparisonType::LessThan:
+    case ComparisonType::LessThanOrEqual:
+      MakeBound(value, swapped ? &lower_ : &upper_);
+      break;
+    case ComparisonType::GreaterThan:
+    case ComparisonType::GreaterThanOrEqual:
+      MakeBound(value, swapped ? &upper_ : &lower_);
+      break;
+    default:
+      break;
+  }
+}
+
+auto IndexScanExecutor::MakeBound(const Value &value, std::optional<Tuple> *bound) -> bool {
+  const Schema *key_schema = index_info_->index_->GetKeySchema();
+  if (value.IsNull() || value.GetTypeId() != key_schema->GetColumn(0).GetType()) {
+    return false;
+  }
+  // The other key columns are NULL, which compares equal to every value. The index orders entries of equal keys
+  // by their RID, and bounds the lower key with the smallest RID and the upper key with the largest, so every
+  // entry with the first column's value lies strictly between the bounds and no descent lands past one of them.
+  std::vector<Value> values{value};
+  for (uint32_t i = 1; i < key_schema->GetColumnCount(); i++) {
+    const Column &column = key_schema->GetColumn(i);
+    if (!column.IsInlined()) {
+      return false;
+    }
+    values.push_back(ValueFactory::GetNullValueByType(column.GetType()));
+  }
+  bound->emplace(values, key_schema);
+  return true;
+}
+
+void IndexScanExecutor::Init() {
+  cursor_ = index_info_->index_->Scan(lower_.has_value() ? &lower_.value() : nullptr,
+                                      upper_.has_value() ? &upper_.value() : nullptr, exec_ctx_->GetTransaction());
+  if (cursor_ == nullptr) {
+    throw Exception(ExceptionType::NOT_IMPLEMENTED, "index scans need an index that keeps its keys in order");
+  }
+  batch_rids_.clear();
+  batch_pos_ = 0;
+}
+
+auto IndexScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  Transaction *txn = exec_ctx_->GetTransaction();
+  if (!index_only_) {
+    while (batch_pos_ < batch_rids_.size() || FetchBatch()) {
+      size_t i = batch_pos_++;
+      if (batch_found_[i] && Emit(batch_tuples_[i], tuple)) {
+        *rid = batch_rids_[i];
+        return true;
+      }
+    }
+    return false;
+  }
+
+  const auto &key_attrs = index_info_->index_->GetKeyAttrs();
+  RID entry_rid;
+  while (cursor_->Next(&entry_rid, &key_values_)) {
+    bool acquire_lock = false;
+    if (txn->GetIsolationLevel() != IsolationLevel::READ_UNCOMMITTED &&
+        txn->GetSharedLockSet()->find(entry_rid) == txn->GetSharedLockSet()->end() &&
+        txn->GetExclusiveLockSet()->find(entry_rid) == txn->GetExclusiveLockSet()->end()) {
+      exec_ctx_->GetLockManager()->LockShared(txn, entry_rid);
+      acquire_lock = true;
+    }
+    for (uint32_t i = 0; i < key_attrs.size(); i++) {
+      row_values_[key_attrs[i]] = key_values_[i];
+    }
+    bool match = Emit(Tuple(row_values_, &table_info_->schema_), tuple);
+    if (acquire_lock && txn->GetIsolationLevel() == IsolationLevel::READ_COMMITTED) {
+      exec_ctx_->GetLockManager()->Unlock(txn, entry_rid);
+    }
+    if (match) {
+      *rid = entry_rid;
+      return true;
+    }
+  }
+  return false;
+}
+
+auto IndexScanExecutor::FetchBatch() -> bool {
+  batch_rids_.clear();
+  batch_pos_ = 0;
+  RID entry_rid;
+  while (batch_rids_.size() < BATCH_SIZE && cursor_->Next(&entry_rid, nullptr)) {
+    batch_rids_.push_back(entry_rid);
+  }
+  if (batch_rids_.empty()) {
+    return false;
+  }
 
-void IndexScanExecutor::Init() {}
+  Transaction *txn = exec_ctx_->GetTransaction();
+  std::vector<RID> locked;
+  if (txn->GetIsolationLevel() != IsolationLevel::READ_UNCOMMITTED) {
+    for (const RID &rid : batch_rids_) {
+      if (txn->GetSharedLockSet()->find(rid) == txn->GetSharedLockSet()->end() &&
+          txn->GetExclusiveLockSet()->find(rid) == txn->GetExclusiveLockSet()->end()) {
+        exec_ctx_->GetLockManager()->LockShared(txn, rid);
+        locked.push_back(rid);
+      }
+    }
+  }
+  bool fetched = table_info_->table_->GetTuples(batch_rids_, &batch_tuples_, &batch_found_, txn);
+  if (txn->GetIsolationLevel() == IsolationLevel::READ_COMMITTED) {
+    for (const RID &rid : locked) {
+      exec_ctx_->GetLockManager()->Unlock(txn, rid);
+    }
+  }
+  if (!fetched) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch a page of the table heap");
+  }
+  return true;
+}
 
-auto IndexScanExecutor::Next(Tuple *tuple, RID *rid) -> bool { return false; }
+auto IndexScanExecutor::Emit(const Tuple &row, Tuple *tuple) -> bool {
+  const Schema *schema = &table_info_->schema_;
+  if (plan_->GetPredicate() != nullptr && !plan_->GetPredicate()->Evaluate(&row, schema).GetAs<bool>()) {
+    return false;
+  }
+  const Schema *output_schema = plan_->OutputSchema();
+  std::vector<Value> values;
+  values.reserve(output_schema->GetColumnCount());
+  for (const Column &column : output_schema->GetColumns()) {
+    values.push_back(column.GetExpr()->Evaluate(&row, schema));
+  }
+  *tuple = Tuple(values, output_schema);
+  return true;
+}
 
 }  // namespace bustub
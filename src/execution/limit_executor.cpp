@@ -10,6 +10,8 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+
 #include "execution/executors/limit_executor.h"
 using std::move;
 namespace bustub {
@@ -35,4 +37,18 @@ auto LimitExecutor::Next(Tuple *tuple, RID *rid) -> bool {
   return false;
 }
 
+auto LimitExecutor::NextBatch(TupleBatch *batch) -> bool {
+  batch->Clear();
+  if (ptr_ >= plan_->GetLimit()) {
+    return false;
+  }
+  // the child produces, and under REPEATABLE_READ locks, no more tuples than the limit still takes
+  size_t limit = batch->GetLimit();
+  batch->SetLimit(std::min(limit, plan_->GetLimit() - ptr_));
+  bool ok = child_executor_->NextBatch(batch);
+  batch->SetLimit(limit);
+  ptr_ += batch->Size();
+  return ok;
+}
+
 }  // namespace bustub
@@ -10,16 +10,143 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+
+#include "common/exception.h"
 #include "execution/executors/nested_index_join_executor.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
 
 namespace bustub {
 
+/*
+ * Whether an expression reads only columns of the outer tuple of a join.
+ */
+static auto ReadsOuterOnly(const AbstractExpression *expr) -> bool {
+  if (const auto *column = dynamic_cast<const ColumnValueExpression *>(expr); column != nullptr) {
+    return column->GetTupleIdx() == 0;
+  }
+  const auto &children = expr->GetChildren();
+  return std::all_of(children.begin(), children.end(), ReadsOuterOnly);
+}
+
 NestIndexJoinExecutor::NestIndexJoinExecutor(ExecutorContext *exec_ctx, const NestedIndexJoinPlanNode *plan,
                                              std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {
+  Catalog *catalog = exec_ctx_->GetCatalog();
+  inner_table_ = catalog->GetTable(plan_->GetInnerTableOid());
+  index_info_ = catalog->GetIndex(plan_->GetIndexName(), inner_table_->name_);
+}
+
+void NestIndexJoinExecutor::Init() {
+  const auto *comparison = dynamic_cast<const ComparisonExpression *>(plan_->Predicate());
+  if (comparison == nullptr || comparison->GetComparisonType() != ComparisonType::Equal ||
+      index_info_ == Catalog::NULL_INDEX_INFO || index_info_->key_schema_.GetColumnCount() != 1) {
+    throw Exception(ExceptionType::NOT_IMPLEMENTED, "index joins need an equality on a single column index");
+  }
+  probe_expr_ = ReadsOuterOnly(comparison->GetChildAt(0)) ? comparison->GetChildAt(0) : comparison->GetChildAt(1);
+  child_executor_->Init();
+  results_.clear();
+  result_pos_ = 0;
+}
+
+auto NestIndexJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  while (result_pos_ == results_.size()) {
+    if (!JoinBatch()) {
+      return false;
+    }
+  }
+  *tuple = results_[result_pos_++];
+  return true;
+}
+
+auto NestIndexJoinExecutor::JoinBatch() -> bool {
+  results_.clear();
+  result_pos_ = 0;
+  const Schema *outer_schema = plan_->GetChildPlan()->OutputSchema();
+  const Schema *inner_schema = &inner_table_->schema_;
+  const Schema *key_schema = &index_info_->key_schema_;
+  TypeId key_type = key_schema->GetColumn(0).GetType();
+
+  // the outer tuples of the batch and their keys, NULL keys match nothing
+  std::vector<Tuple> outer_tuples;
+  std::vector<Value> keys;
+  Tuple outer_tuple;
+  RID outer_rid;
+  while (outer_tuples.size() < BATCH_SIZE && child_executor_->Next(&outer_tuple, &outer_rid)) {
+    Value key = probe_expr_->Evaluate(&outer_tuple, outer_schema);
+    keys.push_back(key.IsNull() || key.GetTypeId() == key_type ? key : key.CastAs(key_type));
+    outer_tuples.push_back(outer_tuple);
+  }
+  if (outer_tuples.empty()) {
+    return false;
+  }
+
+  // probe the keys in key order, once for equal keys
+  std::vector<size_t> order;
+  for (size_t i = 0; i < keys.size(); i++) {
+    if (!keys[i].IsNull()) {
+      order.push_back(i);
+    }
+  }
+  std::sort(order.begin(), order.end(),
+            [&keys](size_t lhs, size_t rhs) { return keys[lhs].CompareLessThan(keys[rhs]) == CmpBool::CmpTrue; });
+  std::vector<std::pair<size_t, RID>> matches;
+  std::vector<RID> key_rids;
+  for (size_t i = 0; i < order.size(); i++) {
+    const Value &key = keys[order[i]];
+    if (i == 0 || keys[order[i - 1]].CompareEquals(key) != CmpBool::CmpTrue) {
+      key_rids.clear();
+      index_info_->index_->ScanKey(Tuple({key}, key_schema), &key_rids, exec_ctx_->GetTransaction());
+    }
+    for (const RID &inner_rid : key_rids) {
+      matches.emplace_back(order[i], inner_rid);
+    }
+  }
+  std::stable_sort(matches.begin(), matches.end(),
+                   [](const auto &lhs, const auto &rhs) { return lhs.first < rhs.first; });
 
-void NestIndexJoinExecutor::Init() {}
+  // read the inner tuples of the whole batch, visiting the pages in order
+  Transaction *txn = exec_ctx_->GetTransaction();
+  std::vector<RID> inner_rids;
+  std::vector<RID> locked;
+  inner_rids.reserve(matches.size());
+  for (const auto &match : matches) {
+    inner_rids.push_back(match.second);
+    if (txn->GetIsolationLevel() != IsolationLevel::READ_UNCOMMITTED &&
+        txn->GetSharedLockSet()->find(match.second) == txn->GetSharedLockSet()->end() &&
+        txn->GetExclusiveLockSet()->find(match.second) == txn->GetExclusiveLockSet()->end()) {
+      exec_ctx_->GetLockManager()->LockShared(txn, match.second);
+      locked.push_back(match.second);
+    }
+  }
+  std::vector<Tuple> inner_tuples;
+  std::vector<bool> found;
+  bool fetched = inner_table_->table_->GetTuples(inner_rids, &inner_tuples, &found, txn);
+  if (txn->GetIsolationLevel() == IsolationLevel::READ_COMMITTED) {
+    for (const RID &inner_rid : locked) {
+      exec_ctx_->GetLockManager()->Unlock(txn, inner_rid);
+    }
+  }
+  if (!fetched) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch a page of the inner table");
+  }
 
-auto NestIndexJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool { return false; }
+  const Schema *output_schema = plan_->OutputSchema();
+  for (size_t i = 0; i < matches.size(); i++) {
+    const Tuple &outer = outer_tuples[matches[i].first];
+    if (!found[i] ||
+        !plan_->Predicate()->EvaluateJoin(&outer, outer_schema, &inner_tuples[i], inner_schema).GetAs<bool>()) {
+      continue;
+    }
+    std::vector<Value> values;
+    values.reserve(output_schema->GetColumnCount());
+    for (const Column &column : output_schema->GetColumns()) {
+      values.push_back(column.GetExpr()->EvaluateJoin(&outer, outer_schema, &inner_tuples[i], inner_schema));
+    }
+    results_.emplace_back(values, output_schema);
+  }
+  return true;
+}
 
 }  // namespace bustub
@@ -1,67 +1,183 @@
-//===----------------------------------------------------------------------===//
-//
-//                         BusTub
-//
-// seq_scan_executor.cpp
-//
-// Identification: src/execution/seq_scan_executor.cpp
-//
-// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
-//
-//===----------------------------------------------------------------------===//
-
-#include "execution/executors/seq_scan_executor.h"
-using std::cout, std::endl, std::vector, std::string;
-namespace bustub {
-
-SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan)
-    : AbstractExecutor(exec_ctx), plan_(plan), iterator_(nullptr, RID{}, nullptr) {
-  table_oid_t table_id = plan_->GetTableOid();
-  table_ = exec_ctx_->GetCatalog()->GetTable(table_id);
-}
-
-void SeqScanExecutor::Init() { iterator_ = table_->table_->Begin(exec_ctx_->GetTransaction()); }
-
-auto SeqScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
-  const Schema *output_schema = plan_->OutputSchema();
-  while (iterator_ != table_->table_->End()) {
-    Transaction *txn = exec_ctx_->GetTransaction();
-    bool acquire_lock = false;
-    if (txn->GetIsolationLevel() != IsolationLevel::READ_UNCOMMITTED &&
-        txn->GetSharedLockSet()->find(iterator_->GetRid()) == txn->GetSharedLockSet()->end() &&
-        txn->GetExclusiveLockSet()->find(iterator_->GetRid()) == txn->GetExclusiveLockSet()->end()) {
-      exec_ctx_->GetLockManager()->LockShared(txn, iterator_->GetRid());
-      acquire_lock = true;
-    }
-
-    if (plan_->GetPredicate() == nullptr ||
-        plan_->GetPredicate()->Evaluate(&(*iterator_), &(table_->schema_)).GetAs<bool>()) {
-      // we need to construct it based on output schema
-      Tuple old_tuple = *iterator_;
-
-      vector<Value> values;
-      for (uint32_t i = 0; i < output_schema->GetColumnCount(); i++) {
-        values.push_back(output_schema->GetColumn(i).GetExpr()->Evaluate(&old_tuple, &table_->schema_));
-        // string column_name = output_schema->GetColumn(i).GetName();
-        // values.push_back(old_tuple.GetValue(&table_->schema_, table_->schema_.GetColIdx(column_name)));
-      }
-      Tuple output_tuple(values, output_schema);
-
-      (*tuple) = output_tuple;
-
-      *rid = iterator_->GetRid();
-      ++iterator_;
-      if (acquire_lock && txn->GetIsolationLevel() == IsolationLevel::READ_COMMITTED) {
-        exec_ctx_->GetLockManager()->Unlock(txn, *rid);
-      }
-      return true;
-    }
-    ++iterator_;
-    if (acquire_lock && txn->GetIsolationLevel() == IsolationLevel::READ_COMMITTED) {
-      exec_ctx_->GetLockManager()->Unlock(txn, *rid);
-    }
-  }
-
-  return false;
-}
-}  // namespace bustub
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// seq_scan_executor.cpp
+//
+// Identification: src/execution/seq_scan_executor.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+
+#include "common/exception.h"
+#include "execution/executors/seq_scan_executor.h"
+using std::cout, std::endl, std::vector, std::string;
+namespace bustub {
+
+SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan)
+    : AbstractExecutor(exec_ctx), plan_(plan), iterator_(nullptr, RID{}, nullptr) {
+  table_oid_t table_id = plan_->GetTableOid();
+  table_ = exec_ctx_->GetCatalog()->GetTable(table_id);
+}
+
+void SeqScanExecutor::Init() {
+  iterator_ = table_->table_->Begin(exec_ctx_->GetTransaction());
+  next_page_id_ = table_->table_->GetFirstPageId();
+  page_rids_.clear();
+  page_rid_pos_ = 0;
+
+  // evaluating the predicate on no rows tells whether it can be evaluated by column at all
+  const Schema &schema = table_->schema_;
+  column_predicate_ = dynamic_cast<const ComparisonExpression *>(plan_->GetPredicate());
+  predicate_columns_.clear();
+  columns_.clear();
+  if (column_predicate_ != nullptr) {
+    for (const AbstractExpression *child : column_predicate_->GetChildren()) {
+      if (const auto *column = dynamic_cast<const ColumnValueExpression *>(child); column != nullptr) {
+        predicate_columns_.push_back(column->GetColIdx());
+      }
+    }
+    columns_.resize(schema.GetColumnCount());
+    for (uint32_t col_idx : predicate_columns_) {
+      columns_[col_idx].Reset(schema.GetColumn(col_idx).GetType());
+    }
+    SelectionVector selection;
+    if (!column_predicate_->EvaluateBatch(columns_, &selection)) {
+      column_predicate_ = nullptr;
+    }
+  }
+}
+
+auto SeqScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  const Schema *output_schema = plan_->OutputSchema();
+  while (iterator_ != table_->table_->End()) {
+    Transaction *txn = exec_ctx_->GetTransaction();
+    bool acquire_lock = false;
+    if (txn->GetIsolationLevel() != IsolationLevel::READ_UNCOMMITTED &&
+        txn->GetSharedLockSet()->find(iterator_->GetRid()) == txn->GetSharedLockSet()->end() &&
+        txn->GetExclusiveLockSet()->find(iterator_->GetRid()) == txn->GetExclusiveLockSet()->end()) {
+      exec_ctx_->GetLockManager()->LockShared(txn, iterator_->GetRid());
+      acquire_lock = true;
+    }
+
+    if (plan_->GetPredicate() == nullptr ||
+        plan_->GetPredicate()->Evaluate(&(*iterator_), &(table_->schema_)).GetAs<bool>()) {
+      // we need to construct it based on output schema
+      Tuple old_tuple = *iterator_;
+
+      vector<Value> values;
+      for (uint32_t i = 0; i < output_schema->GetColumnCount(); i++) {
+        values.push_back(output_schema->GetColumn(i).GetExpr()->Evaluate(&old_tuple, &table_->schema_));
+        // string column_name = output_schema->GetColumn(i).GetName();
+        // values.push_back(old_tuple.GetValue(&table_->schema_, table_->schema_.GetColIdx(column_name)));
+      }
+      Tuple output_tuple(values, output_schema);
+
+      (*tuple) = output_tuple;
+
+      *rid = iterator_->GetRid();
+      ++iterator_;
+      if (acquire_lock && txn->GetIsolationLevel() == IsolationLevel::READ_COMMITTED) {
+        exec_ctx_->GetLockManager()->Unlock(txn, *rid);
+      }
+      return true;
+    }
+    ++iterator_;
+    if (acquire_lock && txn->GetIsolationLevel() == IsolationLevel::READ_COMMITTED) {
+      exec_ctx_->GetLockManager()->Unlock(txn, *rid);
+    }
+  }
+
+  return false;
+}
+
+auto SeqScanExecutor::NextBatch(TupleBatch *batch) -> bool {
+  batch->Clear();
+  Transaction *txn = exec_ctx_->GetTransaction();
+  const Schema *output_schema = plan_->OutputSchema();
+  vector<RID> rids;
+  vector<RID> locked;
+  vector<Tuple> tuples;
+  vector<bool> found;
+  SelectionVector selection;
+  vector<Value> values;
+  values.reserve(output_schema->GetColumnCount());
+  while (!batch->IsFull()) {
+    if (page_rid_pos_ == page_rids_.size()) {
+      if (next_page_id_ == INVALID_PAGE_ID) {
+        break;
+      }
+      page_rids_.clear();
+      page_rid_pos_ = 0;
+      if (!table_->table_->GetPageRids(next_page_id_, &page_rids_, &next_page_id_, txn)) {
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch a page of the scanned table");
+      }
+      continue;
+    }
+
+    // read as many tuples of the page as the batch has room for
+    size_t count = std::min(page_rids_.size() - page_rid_pos_, batch->Room());
+    rids.assign(page_rids_.begin() + page_rid_pos_, page_rids_.begin() + page_rid_pos_ + count);
+    page_rid_pos_ += count;
+    locked.clear();
+    for (const RID &rid : rids) {
+      if (txn->GetIsolationLevel() != IsolationLevel::READ_UNCOMMITTED &&
+          txn->GetSharedLockSet()->find(rid) == txn->GetSharedLockSet()->end() &&
+          txn->GetExclusiveLockSet()->find(rid) == txn->GetExclusiveLockSet()->end()) {
+        exec_ctx_->GetLockManager()->LockShared(txn, rid);
+        locked.push_back(rid);
+      }
+    }
+    bool fetched = table_->table_->GetTuples(rids, &tuples, &found, txn);
+    if (txn->GetIsolationLevel() == IsolationLevel::READ_COMMITTED) {
+      for (const RID &rid : locked) {
+        exec_ctx_->GetLockManager()->Unlock(txn, rid);
+      }
+    }
+    if (!fetched) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch a page of the scanned table");
+    }
+
+    // the predicate narrows the selection of the tuples read, only the selected tuples are projected
+    selection.clear();
+    for (uint32_t i = 0; i < rids.size(); i++) {
+      if (found[i]) {
+        selection.push_back(i);
+      }
+    }
+    if (column_predicate_ != nullptr) {
+      for (uint32_t col_idx : predicate_columns_) {
+        ColumnVector &column = columns_[col_idx];
+        column.Clear();
+        for (size_t i = 0; i < tuples.size(); i++) {
+          if (found[i]) {
+            column.Append(tuples[i], &table_->schema_, col_idx);
+          } else {
+            column.AppendNull();
+          }
+        }
+      }
+      column_predicate_->EvaluateBatch(columns_, &selection);
+    } else if (plan_->GetPredicate() != nullptr) {
+      selection.erase(std::remove_if(selection.begin(), selection.end(),
+                                     [&](uint32_t i) {
+                                       return !plan_->GetPredicate()
+                                                   ->Evaluate(&tuples[i], &(table_->schema_))
+                                                   .GetAs<bool>();
+                                     }),
+                      selection.end());
+    }
+    for (uint32_t i : selection) {
+      values.clear();
+      for (const Column &column : output_schema->GetColumns()) {
+        values.push_back(column.GetExpr()->Evaluate(&tuples[i], &table_->schema_));
+      }
+      batch->Append(Tuple(values, output_schema), rids[i]);
+    }
+  }
+  return !batch->IsEmpty();
+}
+}  // namespace bustub
@@ -20,9 +20,12 @@
 
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/schema.h"
+#include "common/exception.h"
 #include "container/hash/hash_function.h"
+#include "storage/index/b_plus_tree_index.h"
 #include "storage/index/extendible_hash_table_index.h"
 #include "storage/index/index.h"
+#include "storage/page/header_page.h"
 #include "storage/table/table_heap.h"
 
 namespace bustub {
@@ -34,6 +37,9 @@ using table_oid_t = uint32_t;
 using column_oid_t = uint32_t;
 using index_oid_t = uint32_t;
 
+/** The kinds of index the catalog can create. */
+enum class IndexType { HashTableIndex, BPlusTreeIndex };
+
 /**
  * The TableInfo class maintains metadata about a table.
  */
@@ -185,13 +191,15 @@ class Catalog {
    * @param key_schema The schema of the key
    * @param key_attrs Key attributes
    * @param keysize Size of the key
-   * @param hash_function The hash function for the index
+   * @param hash_function The hash function for the index, unused by a B+ tree index
+   * @param index_type The kind of index to create
    * @return A (non-owning) pointer to the metadata of the new table
    */
   template <class KeyType, class ValueType, class KeyComparator>
   auto CreateIndex(Transaction *txn, const std::string &index_name, const std::string &table_name, const Schema &schema,
                    const Schema &key_schema, const std::vector<uint32_t> &key_attrs, std::size_t keysize,
-                   HashFunction<KeyType> hash_function) -> IndexInfo * {
+                   HashFunction<KeyType> hash_function, IndexType index_type = IndexType::HashTableIndex)
+      -> IndexInfo * {
     // Reject the creation request for nonexistent table
     if (table_names_.find(table_name) == table_names_.end()) {
       return NULL_INDEX_INFO;
@@ -211,19 +219,41 @@ class Catalog {
     auto meta = std::make_unique<IndexMetadata>(index_name, table_name, &schema, key_attrs);
 
     // Construct the index, take ownership of metadata
-    // TODO(Kyle): We should update the API for CreateIndex
-    // to allow specification of the index type itself, not
-    // just the key, value, and comparator types
-    auto index = std::make_unique<ExtendibleHashTableIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_,
-                                                                                               hash_function);
-
-    // Populate the index with all tuples in table heap
-    auto *table_meta = GetTable(table_name);
-    auto *heap = table_meta->table_.get();
-    for (auto tuple = heap->Begin(txn); tuple != heap->End(); ++tuple) {
-      index->InsertEntry(tuple->KeyFromTuple(schema, key_schema, key_attrs), tuple->GetRid(), txn);
+    std::unique_ptr<Index> index;
+    BPlusTreeIndex<KeyType, ValueType, KeyComparator> *tree = nullptr;
+    ExtendibleHashTableIndex<KeyType, ValueType, KeyComparator> *hash_table = nullptr;
+    if (index_type == IndexType::BPlusTreeIndex) {
+      auto owned = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_,
+                                                                                       IndexHeaderPageId());
+      tree = owned.get();
+      index = std::move(owned);
+    } else {
+      auto owned = std::make_unique<ExtendibleHashTableIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_,
+                                                                                                 hash_function);
+      hash_table = owned.get();
+      index = std::move(owned);
     }
 
+    // Load the entries of all tuples in table heap in batches. The first batch builds the index in one pass
+    // instead of splitting pages entry by entry, the later ones are inserted into it, so a large table never
+    // has all of its entries in memory at once.
+    auto *heap = GetTable(table_name)->table_.get();
+    std::vector<std::pair<KeyType, ValueType>> entries;
+    auto tuple = heap->Begin(txn);
+    do {
+      entries.clear();
+      for (; tuple != heap->End() && entries.size() < INDEX_BUILD_BATCH_SIZE; ++tuple) {
+        KeyType index_key;
+        index_key.SetFromKey(tuple->KeyFromTuple(schema, key_schema, key_attrs));
+        entries.emplace_back(index_key, tuple->GetRid());
+      }
+      if (tree != nullptr) {
+        tree->BulkLoad(entries, txn);
+      } else {
+        hash_table->BulkLoad(entries, txn);
+      }
+    } while (tuple != heap->End());
+
     // Get the next OID for the new index
     const auto index_oid = next_index_oid_.fetch_add(1);
 
@@ -323,6 +353,26 @@ class Catalog {
   }
 
  private:
+  /** The number of entries CreateIndex reads from the table heap before loading them into the new index */
+  static constexpr std::size_t INDEX_BUILD_BATCH_SIZE = 1 << 16;
+
+  /**
+   * The B+ tree indexes record their root page ids in a header page of their own, as the first page of the
+   * buffer pool may already belong to a table. It is allocated with the first B+ tree index.
+   * @return The page id of the header page
+   */
+  auto IndexHeaderPageId() -> page_id_t {
+    if (index_header_page_id_ == INVALID_PAGE_ID) {
+      auto *header_page = static_cast<HeaderPage *>(bpm_->NewPage(&index_header_page_id_));
+      if (header_page == nullptr) {
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate the header page of the indexes");
+      }
+      header_page->Init();
+      bpm_->UnpinPage(index_header_page_id_, true);
+    }
+    return index_header_page_id_;
+  }
+
   [[maybe_unused]] BufferPoolManager *bpm_;
   [[maybe_unused]] LockManager *lock_manager_;
   [[maybe_unused]] LogManager *log_manager_;
@@ -352,6 +402,9 @@ class Catalog {
 
   /** The next index identifier to be used. */
   std::atomic<index_oid_t> next_index_oid_{0};
+
+  /** The header page of the B+ tree indexes, see IndexHeaderPageId(). */
+  page_id_t index_header_page_id_{INVALID_PAGE_ID};
 };
 
 }  // namespace bustub
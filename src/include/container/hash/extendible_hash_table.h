@@ -12,11 +12,13 @@
 
 #pragma once
 
+#include <mutex>  // NOLINT
 #include <queue>
 #include <string>
 #include <vector>
 #include "buffer/buffer_pool_manager.h"
 #include "concurrency/transaction.h"
+#include "container/hash/extendible_hash_table_iterator.h"
 #include "container/hash/hash_function.h"
 #include "storage/page/hash_table_bucket_page.h"
 #include "storage/page/hash_table_directory_page.h"
@@ -46,6 +48,11 @@ class ExtendibleHashTable {
   /**
    * Inserts a key-value pair into the hash table.
    *
+   * The insert first runs optimistically, holding the table latch in read mode and
+   * only the target bucket's write latch. When the bucket is full and has to be
+   * split, the table latch is taken in write mode only for publishing the new
+   * directory.
+   *
    * @param transaction the current transaction
    * @param key the key to create
    * @param value the value to be associated with the key
@@ -73,6 +80,32 @@ class ExtendibleHashTable {
    */
   auto GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) -> bool;
 
+  /**
+   * Builds the hash table from many pairs at once, e.g. when an index is created
+   * on an existing table.
+   *
+   * The directory is sized up front from the number of pairs, the pairs are
+   * partitioned by their hash bits, and each bucket page is written exactly once
+   * without any split. A partition that does not fit into a bucket is divided
+   * further by the next hash bit, or chained if its hashes cannot be told apart.
+   * If the table is not empty, the pairs are inserted one by one instead.
+   *
+   * @param transaction the current transaction
+   * @param pairs the pairs to insert, without duplicate pairs
+   * @return false if a page could not be allocated
+   */
+  auto BulkLoad(Transaction *transaction, const std::vector<MappingType> &pairs) -> bool;
+
+  /**
+   * @return an iterator over all entries of the table, see ExtendibleHashTableIterator
+   */
+  auto Begin() -> ExtendibleHashTableIterator<KeyType, ValueType, KeyComparator>;
+
+  /**
+   * @return the end iterator
+   */
+  auto End() -> ExtendibleHashTableIterator<KeyType, ValueType, KeyComparator>;
+
   /**
    * Returns the global depth.  Do not touch.
    */
@@ -86,6 +119,8 @@ class ExtendibleHashTable {
   void PrintPageDirectory();
 
  private:
+  friend class ExtendibleHashTableIterator<KeyType, ValueType, KeyComparator>;
+
   /**
    * Hash - simple helper to downcast MurmurHash's 64-bit hash to 32-bit
    * for extendible hashing.
@@ -138,7 +173,93 @@ class ExtendibleHashTable {
   auto FetchBucketPage(page_id_t bucket_page_id) -> HASH_TABLE_BUCKET_TYPE *;
 
   /**
-   * Performs insertion with an optional bucket splitting.
+   * Looks up a key in a bucket page and every overflow page chained behind it.
+   * The caller holds the latch of the bucket page, which covers its whole chain.
+   *
+   * @param bucket the primary bucket page
+   * @param key the key to look up
+   * @param[out] result the values associated with the key
+   * @return true if at least one value was found
+   */
+  auto ChainGetValue(HASH_TABLE_BUCKET_TYPE *bucket, const KeyType &key, std::vector<ValueType> *result) -> bool;
+
+  /**
+   * @param bucket the primary bucket page
+   * @return whether the bucket page and all of its overflow pages are full
+   */
+  auto ChainIsFull(HASH_TABLE_BUCKET_TYPE *bucket) -> bool;
+
+  /**
+   * Inserts a pair into the first page of the bucket's chain with a free slot,
+   * linking a new overflow page at the end if there is none.
+   *
+   * @param bucket the primary bucket page, write latched by the caller
+   * @param key the key to insert
+   * @param value the value to insert
+   * @return false if the pair already exists in the chain or no page could be allocated
+   */
+  auto ChainInsert(HASH_TABLE_BUCKET_TYPE *bucket, const KeyType &key, const ValueType &value) -> bool;
+
+  /**
+   * Removes a pair from the bucket's chain. Overflow pages that become empty are
+   * unlinked and deleted, and an emptied primary page takes over the entries of the
+   * first overflow page, so an empty primary page never has a chain.
+   *
+   * @param bucket the primary bucket page, write latched by the caller
+   * @param key the key to remove
+   * @param value the value to remove
+   * @return whether the pair was found
+   */
+  auto ChainRemove(HASH_TABLE_BUCKET_TYPE *bucket, const KeyType &key, const ValueType &value) -> bool;
+
+  /**
+   * Decides between splitting a full bucket and growing its overflow chain. Splitting
+   * only helps if some entry's hash differs from the key's hash in a bit the
+   * directory can still reach, e.g. never for a bucket full of duplicates.
+   *
+   * @param bucket the primary bucket page
+   * @param key the key about to be inserted
+   * @param local_depth the local depth of the bucket
+   * @return whether splitting the bucket can make room for the key
+   */
+  auto SplitCanSeparate(HASH_TABLE_BUCKET_TYPE *bucket, const KeyType &key, uint32_t local_depth) -> bool;
+
+  /**
+   * Splits a bucket into itself and a new split image on a private copy of the
+   * directory, growing it if needed. The entries of the split image are copied
+   * out of the bucket's chain but stay in the bucket, which keeps serving the
+   * published directory until the copy replaces it.
+   *
+   * @param bucket_index a directory index pointing at the bucket
+   * @param bucket the bucket page, write latched by the caller
+   * @param dir_page the unpublished copy of the directory page
+   * @return false if the split image could not be allocated
+   */
+  auto SplitBucket(uint32_t bucket_index, HASH_TABLE_BUCKET_TYPE *bucket, HashTableDirectoryPage *dir_page) -> bool;
+
+  /**
+   * Drops the entries that went to the split image from a split bucket's chain,
+   * once the directory pointing at the image is published.
+   *
+   * @param bucket the bucket page, write latched by the caller
+   * @param local_depth the local depth of the bucket before the split
+   */
+  void DropSplitImage(HASH_TABLE_BUCKET_TYPE *bucket, uint32_t local_depth);
+
+  /**
+   * Copies the entries of a bucket page and its overflow pages.
+   *
+   * @param bucket the primary bucket page
+   * @param[out] entries the entries of the chain
+   * @param free_overflow whether to delete the overflow pages, the caller relinks the bucket
+   */
+  void CollectChain(HASH_TABLE_BUCKET_TYPE *bucket, std::vector<MappingType> *entries, bool free_overflow);
+
+  /**
+   * Performs insertion with an optional bucket splitting. This is the pessimistic
+   * path of Insert. The split is prepared on a copy of the directory while the
+   * table latch is shared, and the table latch is taken in write mode only to
+   * publish the copy.
    *
    * @param transaction a pointer to the current transaction
    * @param key the key to insert
@@ -174,8 +295,10 @@ class ExtendibleHashTable {
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
 
-  // Readers includes inserts and removes, writers are splits and merges
+  // Readers includes inserts, writers are merges and the publication of a new directory
   ReaderWriterLatch table_latch_;
+  // Serializes the operations that change the directory: splits, merges and bulk loads
+  std::mutex structure_latch_;
   HashFunction<KeyType> hash_fn_;
 };
 
@@ -0,0 +1,81 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// extendible_hash_table_iterator.h
+//
+// Identification: src/include/container/hash/extendible_hash_table_iterator.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "storage/page/hash_table_page_defs.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+class ExtendibleHashTable;
+
+#define HASH_TABLE_ITERATOR_TYPE ExtendibleHashTableIterator<KeyType, ValueType, KeyComparator>
+
+/**
+ * Iterator over all entries of an extendible hash table, bucket by bucket in
+ * directory order. A bucket shared by several directory slots is only visited
+ * at the lowest of them, i.e. at the slot whose index fits into its local depth.
+ *
+ * The entries of a bucket and its overflow chain are copied out under the
+ * bucket's read latch, so the iterator holds at most one bucket latch at a time,
+ * and the table latch only while moving to the next bucket. No page stays
+ * pinned between calls, so merges and bulk loads can delete any bucket page.
+ *
+ * The iteration is weakly consistent: every entry that is in the table for the
+ * whole scan and is not moved by a concurrent split or merge is returned exactly
+ * once.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+class ExtendibleHashTableIterator {
+ public:
+  /**
+   * Creates an iterator positioned at the first entry of a table.
+   *
+   * @param table the table to iterate, or nullptr for the end iterator
+   */
+  explicit ExtendibleHashTableIterator(ExtendibleHashTable<KeyType, ValueType, KeyComparator> *table);
+  ExtendibleHashTableIterator(const ExtendibleHashTableIterator &other) = delete;
+  ExtendibleHashTableIterator(ExtendibleHashTableIterator &&other) noexcept;
+  ~ExtendibleHashTableIterator() = default;
+
+  auto IsEnd() const -> bool;
+
+  auto operator*() -> const MappingType &;
+
+  auto operator++() -> ExtendibleHashTableIterator &;
+
+  auto operator==(const ExtendibleHashTableIterator &itr) const -> bool;
+
+  auto operator!=(const ExtendibleHashTableIterator &itr) const -> bool { return !(*this == itr); }
+
+ private:
+  /**
+   * Copies the entries of the next non-empty bucket, or turns into the end
+   * iterator if there is none.
+   */
+  void LoadNextBucket();
+
+  // nullptr once the iteration is over
+  ExtendibleHashTable<KeyType, ValueType, KeyComparator> *table_;
+  // next directory slot to look at
+  uint32_t next_slot_{0};
+  // entries of the current bucket and the position in them
+  std::vector<MappingType> entries_;
+  size_t pos_{0};
+};
+
+}  // namespace bustub
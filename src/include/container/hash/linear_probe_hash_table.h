@@ -12,6 +12,8 @@
 
 #pragma once
 
+#include <atomic>
+#include <mutex>  // NOLINT
 #include <queue>
 #include <string>
 #include <vector>
@@ -32,12 +34,24 @@ namespace bustub {
  * Implementation of linear probing hash table that is backed by a buffer pool
  * manager. Non-unique keys are supported. Supports insert and delete. The
  * table dynamically grows once full.
+ *
+ * Slots are spread over block pages listed in a header page. Probing latches
+ * one block page at a time, and removes leave tombstones so that probe
+ * sequences stay intact. Operations on the same key are serialized by a
+ * striped key latch, which keeps concurrent inserts from adding the same pair
+ * twice.
+ *
+ * Resizing is incremental: Resize only allocates the bigger table, and every
+ * following insert and remove migrates one block of the old table into it.
+ * Until the last block is moved, lookups consult both tables, and the table is
+ * not grown any further.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class LinearProbeHashTable : public HashTable<KeyType, ValueType, KeyComparator> {
  public:
   /**
-   * Creates a new LinearProbeHashTable
+   * Creates a new LinearProbeHashTable. Throws OUT_OF_MEMORY if the buffer
+   * pool cannot hold the pages of the table.
    *
    * @param buffer_pool_manager buffer pool manager to be used
    * @param comparator comparator for keys
@@ -75,10 +89,14 @@ class LinearProbeHashTable : public HashTable<KeyType, ValueType, KeyComparator>
   auto GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) -> bool override;
 
   /**
-   * Resizes the table to at least twice the initial size provided.
+   * Resizes the table to at least twice the initial size provided. Only the
+   * new table is allocated here, the pairs are migrated block by block by the
+   * following inserts and removes. While a migration is in progress, the table
+   * is left as it is.
    * @param initial_size the initial size of the hash table
+   * @return false if the bigger table could not be allocated
    */
-  void Resize(size_t initial_size);
+  auto Resize(size_t initial_size) -> bool;
 
   /**
    * Gets the size of the hash table
@@ -87,16 +105,104 @@ class LinearProbeHashTable : public HashTable<KeyType, ValueType, KeyComparator>
   auto GetSize() -> size_t;
 
  private:
+  /** Number of stripes of the key latches */
+  static constexpr size_t KEY_LATCH_STRIPES = 64;
+
+  /**
+   * Allocates the header page and block pages of a table.
+   *
+   * @param num_buckets the number of slots of the table
+   * @return the page id of the header page, INVALID_PAGE_ID if the pages could not be allocated
+   */
+  auto CreateTable(size_t num_buckets) -> page_id_t;
+
+  /**
+   * Deletes the header page and all block pages of a table.
+   *
+   * @param header_page_id the page id of the header page
+   */
+  void DeleteTable(page_id_t header_page_id);
+
+  /**
+   * Walks the probe sequence of a table starting at a slot, latching one block
+   * page at a time. The walk ends after visiting the first never occupied slot,
+   * when visit returns true, or after every slot has been visited once.
+   *
+   * @param header the header page of the table
+   * @param slot the slot to start at
+   * @param exclusive whether to write latch the block pages
+   * @param visit called as visit(block, offset, &dirty) for every slot
+   */
+  template <typename Visitor>
+  void Probe(HashTableHeaderPage *header, size_t slot, bool exclusive, Visitor &&visit);
+
+  /**
+   * Collects the values of a key in one table.
+   */
+  auto TableGetValue(HashTableHeaderPage *header, const KeyType &key, size_t hash, std::vector<ValueType> *result)
+      -> bool;
+
+  /**
+   * Looks for a pair in one table.
+   *
+   * @param[out] free_slot the first slot of the probe sequence without a readable pair, if any
+   * @return whether the pair is in the table
+   */
+  auto TableContains(HashTableHeaderPage *header, const KeyType &key, const ValueType &value, size_t hash,
+                     size_t *free_slot) -> bool;
+
+  /**
+   * Claims the first slot without a readable pair at or after a slot. The caller
+   * has checked for duplicates.
+   *
+   * @return false if the table is full
+   */
+  auto TableInsert(HashTableHeaderPage *header, const KeyType &key, const ValueType &value, size_t slot) -> bool;
+
+  /**
+   * Removes a pair from one table.
+   */
+  auto TableRemove(HashTableHeaderPage *header, const KeyType &key, const ValueType &value, size_t hash) -> bool;
+
+  /**
+   * Moves the next unclaimed block of the old table into the current one. The
+   * caller holds the table latch.
+   *
+   * @return true if this call moved the last block, so the old table can go
+   */
+  auto MigrateBlock() -> bool;
+
+  /**
+   * Deletes the old table once all of its blocks have been migrated.
+   */
+  void FinishResize();
+
+  auto FetchHeaderPage(page_id_t header_page_id) -> HashTableHeaderPage *;
+  auto KeyLatch(size_t hash) -> std::mutex & { return key_latches_[hash % KEY_LATCH_STRIPES]; }
+
   // member variable
   page_id_t header_page_id_;
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
 
-  // Readers includes inserts and removes, writer is only resize
+  // Readers includes inserts and removes, writer is only starting and finishing a resize
   ReaderWriterLatch table_latch_;
 
   // Hash function
   HashFunction<KeyType> hash_fn_;
+
+  // Inserts, removes and migrations of the same key take the same stripe
+  std::mutex key_latches_[KEY_LATCH_STRIPES];
+
+  // Number of readable pairs, drives the resize
+  std::atomic<size_t> num_pairs_{0};
+
+  // Table being migrated by an incremental resize, INVALID_PAGE_ID if there is none
+  page_id_t old_header_page_id_{INVALID_PAGE_ID};
+  size_t old_num_blocks_{0};
+  // Next block of the old table to be claimed, and the number of blocks already moved
+  std::atomic<size_t> next_migrate_block_{0};
+  std::atomic<size_t> migrated_blocks_{0};
 };
 
 }  // namespace bustub
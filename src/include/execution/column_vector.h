@@ -0,0 +1,100 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// column_vector.h
+//
+// Identification: src/include/execution/column_vector.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "storage/table/tuple.h"
+#include "type/type_id.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/** The positions of the selected rows of a batch, in ascending order */
+using SelectionVector = std::vector<uint32_t>;
+
+/**
+ * ColumnVector holds the values of one column for a batch of rows. Fixed size values are stored
+ * in a contiguous array of their native type, e.g. int32_t for INTEGER and double for DECIMAL,
+ * so a loop over a column reads the values directly. VARCHAR values are stored back to back
+ * with the offset of every value. A bitmap records the rows that are NULL.
+ */
+class ColumnVector {
+ public:
+  /** Create an empty column vector for values of the given type */
+  explicit ColumnVector(TypeId type = TypeId::INVALID) { Reset(type); }
+
+  /** Remove all rows and change the type of the column */
+  void Reset(TypeId type);
+
+  /** Remove all rows */
+  void Clear();
+
+  /** @return The type of the values in the column */
+  auto GetType() const -> TypeId { return type_; }
+
+  /** @return The number of rows in the column */
+  auto Size() const -> size_t { return size_; }
+
+  /** @return `true` if any row of the column is NULL */
+  auto HasNull() const -> bool { return has_null_; }
+
+  /** @return `true` if the row at position {i} is NULL */
+  auto IsNull(size_t i) const -> bool { return ((nulls_[i / 64] >> (i % 64)) & 1) != 0; }
+
+  /** Append the value of a column of a tuple, read straight from the serialized tuple */
+  void Append(const Tuple &tuple, const Schema *schema, uint32_t col_idx);
+
+  /** Append a value of the type of the column */
+  void Append(const Value &value);
+
+  /** Append a NULL row */
+  void AppendNull();
+
+  /** @return The fixed size values of the column, of the native type T of the column type */
+  template <typename T>
+  auto GetData() const -> const T * {
+    return reinterpret_cast<const T *>(data_.data());
+  }
+
+  /** @return The characters of the VARCHAR at position {i}, without the terminating zero, and their number */
+  auto GetVarchar(size_t i, uint32_t *len) const -> const char * {
+    *len = offsets_[i + 1] - offsets_[i] - 1;
+    return data_.data() + offsets_[i];
+  }
+
+  /** @return The row at position {i} as a value */
+  auto GetValue(size_t i) const -> Value;
+
+ private:
+  /** Append a serialized value of the column type, as laid out in a tuple */
+  void AppendSerialized(const char *storage);
+
+  void SetNull(size_t i);
+
+  TypeId type_;
+  /** The size of a fixed size value, or 0 for VARCHAR */
+  uint32_t width_{0};
+  size_t size_{0};
+  bool has_null_{false};
+  /** The values, or the characters of the VARCHAR values including their terminating zero */
+  std::vector<char> data_;
+  /** The offset of every VARCHAR value in data_, followed by the end of the last value */
+  std::vector<uint32_t> offsets_;
+  /** One bit per row, set if the row is NULL */
+  std::vector<uint64_t> nulls_;
+};
+
+}  // namespace bustub
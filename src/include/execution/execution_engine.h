@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <utility>
 #include <vector>
 
 #include "buffer/buffer_pool_manager.h"
@@ -20,6 +21,7 @@
 #include "execution/executor_context.h"
 #include "execution/executor_factory.h"
 #include "execution/plans/abstract_plan.h"
+#include "execution/tuple_batch.h"
 #include "storage/table/tuple.h"
 namespace bustub {
 
@@ -55,14 +57,15 @@ class ExecutionEngine {
     // Prepare the root executor
     executor->Init();
 
-    // Execute the query plan
+    // Execute the query plan, a batch of tuples at a time
     try {
-      Tuple tuple;
-      RID rid;
-      while (executor->Next(&tuple, &rid)) {
+      TupleBatch batch;
+      while (executor->NextBatch(&batch)) {
         if (result_set != nullptr && plan->GetType() != PlanType::Update && plan->GetType() != PlanType::Insert &&
             plan->GetType() != PlanType::Delete) {
-          result_set->push_back(tuple);
+          for (size_t i = 0; i < batch.Size(); i++) {
+            result_set->push_back(std::move(batch.GetTuple(i)));
+          }
         }
       }
     } catch (Exception &e) {
@@ -12,7 +12,10 @@
 
 #pragma once
 
+#include <utility>
+
 #include "execution/executor_context.h"
+#include "execution/tuple_batch.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
@@ -20,6 +23,10 @@ namespace bustub {
  * The AbstractExecutor implements the Volcano tuple-at-a-time iterator model.
  * This is the base class from which all executors in the BustTub execution
  * engine inherit, and defines the minimal interface that all executors support.
+ *
+ * Executors can also produce a batch of tuples per call with NextBatch(), which
+ * saves the virtual call and the bookkeeping of every single tuple. After Init(),
+ * a parent drives an executor either by Next() or by NextBatch(), not both.
  */
 class AbstractExecutor {
  public:
@@ -46,6 +53,21 @@ class AbstractExecutor {
    */
   virtual auto Next(Tuple *tuple, RID *rid) -> bool = 0;
 
+  /**
+   * Yield the next batch of tuples from this executor. By default the batch is filled by Next().
+   * @param[out] batch The batch that receives the next tuples and their RIDs, cleared first
+   * @return `true` if the batch holds a tuple, `false` if there are no more tuples
+   */
+  virtual auto NextBatch(TupleBatch *batch) -> bool {
+    batch->Clear();
+    Tuple tuple;
+    RID rid;
+    while (!batch->IsFull() && Next(&tuple, &rid)) {
+      batch->Append(std::move(tuple), rid);
+    }
+    return !batch->IsEmpty();
+  }
+
   /** @return The schema of the tuples that this executor produces */
   virtual auto GetOutputSchema() -> const Schema * = 0;
 
@@ -177,6 +177,13 @@ class AggregationExecutor : public AbstractExecutor {
    */
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
+  /**
+   * Yield the next batch of groups from the aggregation.
+   * @param[out] batch The batch that receives the next tuples produced by the aggregation
+   * @return `true` if the batch holds a tuple, `false` if there are no more tuples
+   */
+  auto NextBatch(TupleBatch *batch) -> bool override;
+
   /** @return The output schema for the aggregation */
   auto GetOutputSchema() -> const Schema * override { return plan_->OutputSchema(); };
 
@@ -193,6 +200,9 @@ class AggregationExecutor : public AbstractExecutor {
     return {keys};
   }
 
+  /** Advance to the next group that satisfies the having clause, return false after the last group */
+  auto NextGroup(Tuple *tuple) -> bool;
+
   /** @return The tuple as an AggregateValue */
   auto MakeAggregateValue(const Tuple *tuple) -> AggregateValue {
     std::vector<Value> vals;
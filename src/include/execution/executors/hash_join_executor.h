@@ -75,6 +75,13 @@ class HashJoinExecutor : public AbstractExecutor {
    */
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
+  /**
+   * Yield the next batch of tuples from the join. Both children are read by batches.
+   * @param[out] batch The batch that receives the next tuples produced by the join
+   * @return `true` if the batch holds a tuple, `false` if there are no more tuples
+   */
+  auto NextBatch(TupleBatch *batch) -> bool override;
+
   /** @return The output schema for the join */
   auto GetOutputSchema() -> const Schema * override { return plan_->OutputSchema(); };
 
@@ -85,8 +92,14 @@ class HashJoinExecutor : public AbstractExecutor {
   std::unique_ptr<AbstractExecutor> right_child_;
   std::unordered_map<HashJoinKey, std::vector<Tuple>> hash_table_;
 
-  std::vector<Tuple> buffer_;
-  Tuple right_tuple_;
+  /** The batch of right tuples being probed, the right tuple at right_pos_ and its next left match */
+  TupleBatch right_batch_;
+  size_t right_pos_{0};
+  const std::vector<Tuple> *matches_{nullptr};
+  size_t match_pos_{0};
+
+  /** Advance to the next pair of a left and a right tuple with equal keys, return false at the end of the join */
+  auto NextMatch() -> bool;
   Tuple JoinTuple(const Tuple &left, const Tuple &right);
 };
 
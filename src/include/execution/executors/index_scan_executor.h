@@ -12,6 +12,8 @@
 
 #pragma once
 
+#include <memory>
+#include <optional>
 #include <vector>
 
 #include "common/rid.h"
@@ -23,7 +25,19 @@
 namespace bustub {
 
 /**
- * IndexScanExecutor executes an index scan over a table.
+ * IndexScanExecutor executes an index scan over a table, returning the tuples
+ * in the order of the index keys. The index has to keep its keys in order,
+ * like a B+ tree index.
+ *
+ * A predicate that compares the first key column with a constant bounds the
+ * range of keys that is scanned. The predicate is still evaluated on every
+ * tuple in the range.
+ *
+ * If the predicate and the output schema only read columns of the index key,
+ * and the key has no varchar, which the index may have cut off, the scan is
+ * index-only: the tuples are rebuilt from the keys of the index entries, and
+ * the table heap is never read. Otherwise the tuples are read in
+ * batches, visiting the pages of the table heap in order.
  */
 
 class IndexScanExecutor : public AbstractExecutor {
@@ -42,7 +56,43 @@ class IndexScanExecutor : public AbstractExecutor {
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
  private:
+  /** The number of entries whose tuples are read from the table heap at once */
+  static constexpr size_t BATCH_SIZE = 128;
+
+  /** Derive the range of index keys to scan from the predicate */
+  void DeriveBounds();
+
+  /** @return whether the key tuple of a bound could be built from the value of the first key column */
+  auto MakeBound(const Value &value, std::optional<Tuple> *bound) -> bool;
+
+  /** Read the tuples of the next batch of index entries, @return false if there are no more entries */
+  auto FetchBatch() -> bool;
+
+  /** Build the output tuple from a table row, @return false if the predicate rejects the row */
+  auto Emit(const Tuple &row, Tuple *tuple) -> bool;
+
   /** The index scan plan node to be executed. */
   const IndexScanPlanNode *plan_;
+  /** The index to scan */
+  IndexInfo *index_info_;
+  /** The table the index is on */
+  TableInfo *table_info_;
+  /** The entries of the index that are still to be returned */
+  std::unique_ptr<IndexCursor> cursor_;
+  /** Whether the tuples are rebuilt from the index keys instead of read from the table heap */
+  bool index_only_;
+  /** The values of a table row in an index-only scan, the columns outside of the key are never read */
+  std::vector<Value> row_values_;
+  /** The values of the key columns of the current entry in an index-only scan */
+  std::vector<Value> key_values_;
+  /** The smallest and the largest index key to scan, unbounded if not set */
+  std::optional<Tuple> lower_;
+  std::optional<Tuple> upper_;
+  /** The entries of the current batch, their tuples and whether they were found, ordered by key */
+  std::vector<RID> batch_rids_;
+  std::vector<Tuple> batch_tuples_;
+  std::vector<bool> batch_found_;
+  /** The next entry of the current batch to return */
+  size_t batch_pos_{0};
 };
 }  // namespace bustub
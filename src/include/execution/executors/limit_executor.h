@@ -45,6 +45,13 @@ class LimitExecutor : public AbstractExecutor {
    */
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
+  /**
+   * Yield the next batch of tuples from the limit, which cuts the batches of the child.
+   * @param[out] batch The batch that receives the next tuples produced by the limit
+   * @return `true` if the batch holds a tuple, `false` if there are no more tuples
+   */
+  auto NextBatch(TupleBatch *batch) -> bool override;
+
   /** @return The output schema for the limit */
   auto GetOutputSchema() -> const Schema * override { return plan_->OutputSchema(); };
 
@@ -28,7 +28,15 @@
 namespace bustub {
 
 /**
- * IndexJoinExecutor executes index join operations.
+ * IndexJoinExecutor executes index join operations. The predicate has to be an
+ * equality between an expression of the outer tuple and the key column of the
+ * index on the inner table.
+ *
+ * The outer tuples are joined in batches. The keys of a batch are probed in
+ * key order, so equal keys are looked up once and the lookups walk the index
+ * from left to right. The matching inner tuples of a batch are then read with
+ * the pages of the inner table visited in order. The joined tuples keep the
+ * order of the outer tuples.
  */
 class NestIndexJoinExecutor : public AbstractExecutor {
  public:
@@ -48,7 +56,24 @@ class NestIndexJoinExecutor : public AbstractExecutor {
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
  private:
+  /** The number of outer tuples joined at once */
+  static constexpr size_t BATCH_SIZE = 128;
+
+  /** Join the next batch of outer tuples, @return false if the outer table is exhausted */
+  auto JoinBatch() -> bool;
+
   /** The nested index join plan node. */
   const NestedIndexJoinPlanNode *plan_;
+  /** The executor of the outer table */
+  std::unique_ptr<AbstractExecutor> child_executor_;
+  /** The inner table */
+  TableInfo *inner_table_;
+  /** The index on the inner table */
+  IndexInfo *index_info_;
+  /** The side of the predicate that computes the key to probe from an outer tuple */
+  const AbstractExpression *probe_expr_{nullptr};
+  /** The joined tuples of the current batch, and the next one to return */
+  std::vector<Tuple> results_;
+  size_t result_pos_{0};
 };
 }  // namespace bustub
@@ -14,8 +14,10 @@
 
 #include <vector>
 
+#include "execution/column_vector.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
+#include "execution/expressions/comparison_expression.h"
 #include "execution/plans/seq_scan_plan.h"
 #include "storage/table/tuple.h"
 #include "type/value.h"
@@ -44,6 +46,15 @@ class SeqScanExecutor : public AbstractExecutor {
    */
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
+  /**
+   * Yield the next batch of tuples from the sequential scan. The scan lists the tuples
+   * of a page at once and reads them under one fetch of the page. A comparison predicate
+   * is evaluated on the compared columns of the tuples at once, see EvaluateBatch.
+   * @param[out] batch The batch that receives the next tuples produced by the scan
+   * @return `true` if the batch holds a tuple, `false` if there are no more tuples
+   */
+  auto NextBatch(TupleBatch *batch) -> bool override;
+
   /** @return The output schema for the sequential scan */
   auto GetOutputSchema() -> const Schema * override { return plan_->OutputSchema(); }
 
@@ -53,5 +64,15 @@ class SeqScanExecutor : public AbstractExecutor {
 
   TableInfo *table_;
   TableIterator iterator_;
+
+  /** The page that the batched scan lists next, and the tuples of the current page that are not read yet */
+  page_id_t next_page_id_{INVALID_PAGE_ID};
+  std::vector<RID> page_rids_;
+  size_t page_rid_pos_{0};
+
+  /** The predicate if the batched scan evaluates it by column, and the columns it compares */
+  const ComparisonExpression *column_predicate_{nullptr};
+  std::vector<uint32_t> predicate_columns_;
+  std::vector<ColumnVector> columns_;
 };
 }  // namespace bustub
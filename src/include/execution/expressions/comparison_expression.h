@@ -12,12 +12,17 @@
 
 #pragma once
 
+#include <functional>
 #include <utility>
 #include <vector>
 
 #include "catalog/schema.h"
+#include "execution/column_vector.h"
 #include "execution/expressions/abstract_expression.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/constant_value_expression.h"
 #include "storage/table/tuple.h"
+#include "type/type_util.h"
 #include "type/value_factory.h"
 
 namespace bustub {
@@ -54,7 +59,223 @@ class ComparisonExpression : public AbstractExpression {
     return ValueFactory::GetBooleanValue(PerformComparison(lhs, rhs));
   }
 
+  /**
+   * Evaluate the comparison for a batch of rows stored by column, in a loop over the native values of the
+   * column vectors instead of comparing values row by row. Only a column compared with a constant, or two
+   * columns of the same type, can be evaluated this way. Rows where the comparison is NULL are not selected.
+   * @param columns the column vectors of the batch by column index, only the compared columns are read
+   * @param[in,out] selection the rows to evaluate, reduced to the rows where the comparison is true
+   * @return `false` if the comparison cannot be evaluated by column, leaving the selection unchanged
+   */
+  auto EvaluateBatch(const std::vector<ColumnVector> &columns, SelectionVector *selection) const -> bool {
+    const auto *lhs_column = dynamic_cast<const ColumnValueExpression *>(GetChildAt(0));
+    const auto *rhs_column = dynamic_cast<const ColumnValueExpression *>(GetChildAt(1));
+    const auto *lhs_constant = dynamic_cast<const ConstantValueExpression *>(GetChildAt(0));
+    const auto *rhs_constant = dynamic_cast<const ConstantValueExpression *>(GetChildAt(1));
+    if (lhs_column != nullptr && rhs_column != nullptr) {
+      return SelectColumns(columns[lhs_column->GetColIdx()], columns[rhs_column->GetColIdx()], comp_type_, selection);
+    }
+    if (lhs_column != nullptr && rhs_constant != nullptr) {
+      return SelectConstant(columns[lhs_column->GetColIdx()], rhs_constant->Evaluate(nullptr, nullptr), comp_type_,
+                            selection);
+    }
+    if (lhs_constant != nullptr && rhs_column != nullptr) {
+      // (constant op column) is (column mirrored op constant)
+      return SelectConstant(columns[rhs_column->GetColIdx()], lhs_constant->Evaluate(nullptr, nullptr),
+                            Mirror(comp_type_), selection);
+    }
+    return false;
+  }
+
+  /** @return the comparison this expression performs */
+  auto GetComparisonType() const -> ComparisonType { return comp_type_; }
+
  private:
+  static auto Mirror(ComparisonType comp_type) -> ComparisonType {
+    switch (comp_type) {
+      case ComparisonType::LessThan:
+        return ComparisonType::GreaterThan;
+      case ComparisonType::LessThanOrEqual:
+        return ComparisonType::GreaterThanOrEqual;
+      case ComparisonType::GreaterThan:
+        return ComparisonType::LessThan;
+      case ComparisonType::GreaterThanOrEqual:
+        return ComparisonType::LessThanOrEqual;
+      default:
+        return comp_type;
+    }
+  }
+
+  static auto IsNumeric(TypeId type) -> bool {
+    return type == TypeId::TINYINT || type == TypeId::SMALLINT || type == TypeId::INTEGER || type == TypeId::BIGINT ||
+           type == TypeId::DECIMAL;
+  }
+
+  /** Call f with the function object of the comparison, so the loop in f is instantiated for it */
+  template <typename F>
+  static void WithComparison(ComparisonType comp_type, F &&f) {
+    switch (comp_type) {
+      case ComparisonType::Equal:
+        f(std::equal_to<>{});
+        break;
+      case ComparisonType::NotEqual:
+        f(std::not_equal_to<>{});
+        break;
+      case ComparisonType::LessThan:
+        f(std::less<>{});
+        break;
+      case ComparisonType::LessThanOrEqual:
+        f(std::less_equal<>{});
+        break;
+      case ComparisonType::GreaterThan:
+        f(std::greater<>{});
+        break;
+      case ComparisonType::GreaterThanOrEqual:
+        f(std::greater_equal<>{});
+        break;
+    }
+  }
+
+  /** Call f with a value of the native type of a fixed size type, return false for other types */
+  template <typename F>
+  static auto WithNativeType(TypeId type, F &&f) -> bool {
+    switch (type) {
+      case TypeId::BOOLEAN:
+      case TypeId::TINYINT:
+        f(int8_t{});
+        return true;
+      case TypeId::SMALLINT:
+        f(int16_t{});
+        return true;
+      case TypeId::INTEGER:
+        f(int32_t{});
+        return true;
+      case TypeId::BIGINT:
+        f(int64_t{});
+        return true;
+      case TypeId::DECIMAL:
+        f(double{});
+        return true;
+      case TypeId::TIMESTAMP:
+        f(uint64_t{});
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  /** Keep the selected rows that are not NULL in the column and satisfy pred */
+  template <typename Pred>
+  static void SelectRows(const ColumnVector &column, Pred pred, SelectionVector *selection) {
+    size_t selected = 0;
+    if (column.HasNull()) {
+      for (uint32_t row : *selection) {
+        if (!column.IsNull(row) && pred(row)) {
+          (*selection)[selected++] = row;
+        }
+      }
+    } else {
+      for (uint32_t row : *selection) {
+        if (pred(row)) {
+          (*selection)[selected++] = row;
+        }
+      }
+    }
+    selection->resize(selected);
+  }
+
+  /** Compare the values of a column, widened to C, with a constant */
+  template <typename T, typename C>
+  static void SelectTyped(const ColumnVector &column, C constant, ComparisonType comp_type,
+                          SelectionVector *selection) {
+    const T *data = column.GetData<T>();
+    WithComparison(comp_type, [&](auto op) {
+      SelectRows(
+          column, [&](uint32_t row) { return op(static_cast<C>(data[row]), constant); }, selection);
+    });
+  }
+
+  static auto SelectConstant(const ColumnVector &column, const Value &constant, ComparisonType comp_type,
+                             SelectionVector *selection) -> bool {
+    TypeId type = column.GetType();
+    TypeId constant_type = constant.GetTypeId();
+    if (IsNumeric(type) && IsNumeric(constant_type)) {
+      if (constant.IsNull()) {
+        selection->clear();
+        return true;
+      }
+      // integers compare exactly as BIGINT, anything compared with a DECIMAL compares as DECIMAL
+      if (type == TypeId::DECIMAL || constant_type == TypeId::DECIMAL) {
+        auto value = constant.CastAs(TypeId::DECIMAL).GetAs<double>();
+        return WithNativeType(type, [&](auto tag) { SelectTyped<decltype(tag)>(column, value, comp_type, selection); });
+      }
+      auto value = constant.CastAs(TypeId::BIGINT).GetAs<int64_t>();
+      return WithNativeType(type, [&](auto tag) { SelectTyped<decltype(tag)>(column, value, comp_type, selection); });
+    }
+    if (type != constant_type) {
+      return false;
+    }
+    if (constant.IsNull()) {
+      selection->clear();
+      return true;
+    }
+    if (type == TypeId::VARCHAR) {
+      const char *value = constant.GetData();
+      auto value_len = static_cast<int>(constant.GetLength() - 1);
+      WithComparison(comp_type, [&](auto op) {
+        SelectRows(
+            column,
+            [&](uint32_t row) {
+              uint32_t len;
+              const char *str = column.GetVarchar(row, &len);
+              return op(TypeUtil::CompareStrings(str, len, value, value_len), 0);
+            },
+            selection);
+      });
+      return true;
+    }
+    return WithNativeType(type, [&](auto tag) {
+      using T = decltype(tag);
+      SelectTyped<T>(column, constant.GetAs<T>(), comp_type, selection);
+    });
+  }
+
+  static auto SelectColumns(const ColumnVector &lhs, const ColumnVector &rhs, ComparisonType comp_type,
+                            SelectionVector *selection) -> bool {
+    if (lhs.GetType() != rhs.GetType()) {
+      return false;
+    }
+    bool rhs_null = rhs.HasNull();
+    if (lhs.GetType() == TypeId::VARCHAR) {
+      WithComparison(comp_type, [&](auto op) {
+        SelectRows(
+            lhs,
+            [&](uint32_t row) {
+              if (rhs_null && rhs.IsNull(row)) {
+                return false;
+              }
+              uint32_t lhs_len;
+              uint32_t rhs_len;
+              const char *lhs_str = lhs.GetVarchar(row, &lhs_len);
+              const char *rhs_str = rhs.GetVarchar(row, &rhs_len);
+              return op(TypeUtil::CompareStrings(lhs_str, lhs_len, rhs_str, rhs_len), 0);
+            },
+            selection);
+      });
+      return true;
+    }
+    return WithNativeType(lhs.GetType(), [&](auto tag) {
+      using T = decltype(tag);
+      const T *lhs_data = lhs.GetData<T>();
+      const T *rhs_data = rhs.GetData<T>();
+      WithComparison(comp_type, [&](auto op) {
+        SelectRows(
+            lhs, [&](uint32_t row) { return !(rhs_null && rhs.IsNull(row)) && op(lhs_data[row], rhs_data[row]); },
+            selection);
+      });
+    });
+  }
+
   auto PerformComparison(const Value &lhs, const Value &rhs) const -> CmpBool {
     switch (comp_type_) {
       case ComparisonType::Equal:
@@ -0,0 +1,82 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tuple_batch.h
+//
+// Identification: src/include/execution/tuple_batch.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "common/rid.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * TupleBatch holds the tuples that an executor produces by one call of NextBatch(),
+ * together with the RID of every tuple. A parent that needs fewer tuples than
+ * CAPACITY, e.g. a limit, lowers the limit of the batch so the child stops early.
+ */
+class TupleBatch {
+ public:
+  /** The number of tuples that an executor produces at most per batch */
+  static constexpr size_t CAPACITY = 1024;
+
+  TupleBatch() {
+    tuples_.reserve(CAPACITY);
+    rids_.reserve(CAPACITY);
+  }
+
+  /** @return The number of tuples in the batch */
+  auto Size() const -> size_t { return tuples_.size(); }
+
+  /** @return `true` if the batch holds no tuple */
+  auto IsEmpty() const -> bool { return tuples_.empty(); }
+
+  /** @return `true` if the batch holds as many tuples as its limit */
+  auto IsFull() const -> bool { return tuples_.size() >= limit_; }
+
+  /** @return The number of tuples that can still be appended before the batch is full */
+  auto Room() const -> size_t { return IsFull() ? 0 : limit_ - tuples_.size(); }
+
+  /** @return The number of tuples the batch holds at most */
+  auto GetLimit() const -> size_t { return limit_; }
+
+  /** Let the batch hold at most {limit} tuples, which is at most CAPACITY */
+  void SetLimit(size_t limit) { limit_ = std::min(limit, CAPACITY); }
+
+  /** Remove all tuples from the batch */
+  void Clear() {
+    tuples_.clear();
+    rids_.clear();
+  }
+
+  /** Append a tuple and its RID to the batch */
+  void Append(Tuple &&tuple, const RID &rid) {
+    tuples_.emplace_back(std::move(tuple));
+    rids_.emplace_back(rid);
+  }
+
+  /** @return The tuple at position {i}, which the caller may move out of the batch */
+  auto GetTuple(size_t i) -> Tuple & { return tuples_[i]; }
+  auto GetTuple(size_t i) const -> const Tuple & { return tuples_[i]; }
+
+  /** @return The RID of the tuple at position {i} */
+  auto GetRid(size_t i) const -> const RID & { return rids_[i]; }
+
+ private:
+  std::vector<Tuple> tuples_;
+  std::vector<RID> rids_;
+  size_t limit_{CAPACITY};
+};
+
+}  // namespace bustub
@@ -10,10 +10,12 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <optional>
 #include <queue>
 #include <string>
 #include <vector>
 
+#include "common/rwlatch.h"
 #include "concurrency/transaction.h"
 #include "storage/index/index_iterator.h"
 #include "storage/page/b_plus_tree_internal_page.h"
@@ -32,6 +34,21 @@ namespace bustub {
  * (2) support insert & remove
  * (3) The structure should shrink and grow dynamically
  * (4) Implement index iterator for range scan
+ *
+ * Readers descend like in a B-link tree and latch only one page at a time.
+ * Every page links to its right sibling and keeps the fence keys of its range,
+ * the low key and the high key. A reader that finds its key at or past the high
+ * key of a page, because the page split after the reader left the parent,
+ * follows the right link. Keys only move left when pages are merged or
+ * redistributed, which a reader notices by a deleted page or a key below the
+ * low key, and then restarts from the root.
+ *
+ * Writers use latch crabbing: a writer releases all latched ancestors as soon
+ * as it reaches a page that cannot split or underflow. The root page id is
+ * protected by its own latch, which is held like a latch on a page above the
+ * root. Writers first descend optimistically like readers and write latch only
+ * the leaf. Only if the leaf has to split or underflow do they restart from the
+ * root with write latches.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTree {
@@ -39,8 +56,15 @@ class BPlusTree {
   using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
 
  public:
+  // Only the first key_width bytes of the keys are stored, the caller guarantees the rest of every key is zero.
+  // The page sizes are capped at what fits into a page for this width.
+  // A remove merges or redistributes a leaf only once it is less than merge_fill_factor full, at most half full,
+  // and leaves the leaves above that to Compact.
+  // The root page id is recorded under the name of the tree in the header page.
   explicit BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE);
+                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE,
+                     int key_width = sizeof(KeyType), double merge_fill_factor = 0.25,
+                     page_id_t header_page_id = HEADER_PAGE_ID);
 
   // Returns true if this B+ tree has no keys and values.
   auto IsEmpty() const -> bool;
@@ -54,9 +78,35 @@ class BPlusTree {
   // return the value associated with a given key
   auto GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction = nullptr) -> bool;
 
+  // Look up many keys at once, setting the value of each key found at its position in {results}.
+  // The keys are visited in key order, and the keys that land on the same leaf share one descent to it.
+  void BatchLookup(const std::vector<KeyType> &keys, std::vector<std::optional<ValueType>> *results,
+                   Transaction *transaction = nullptr);
+
+  // Insert many pairs at once, visiting them in key order. The pairs that land on the same leaf are inserted
+  // under one write latch of the leaf, only a pair that splits the leaf descends again with write latches.
+  // Only the first pair of a key is inserted, returns the number of pairs inserted.
+  auto BatchInsert(const std::vector<MappingType> &pairs, Transaction *transaction = nullptr) -> int;
+
+  // Merge or redistribute the leaves that removes left less than half full, e.g. from a background thread.
+  // Runs concurrently with all other operations, returns the number of pages deleted.
+  auto Compact(Transaction *transaction = nullptr) -> int;
+
+  // Build an empty tree bottom up from pairs ordered by key, filling each page to the fill factor.
+  // Unordered pairs are sorted first, and only the first pair of a key is kept.
+  // If the tree is not empty, the pairs are inserted one by one instead.
+  // Returns false if a page could not be allocated, leaving the tree empty.
+  auto BulkLoad(const std::vector<MappingType> &pairs, Transaction *transaction = nullptr, double fill_factor = 0.9)
+      -> bool;
+
   // index iterator
   auto Begin() -> INDEXITERATOR_TYPE;
   auto Begin(const KeyType &key) -> INDEXITERATOR_TYPE;
+  // iterate the keys in [lower, upper] in ascending order
+  auto Begin(const KeyType &lower, const KeyType &upper) -> INDEXITERATOR_TYPE;
+  // iterate all keys, or the keys in [lower, upper], in descending order
+  auto RBegin() -> INDEXITERATOR_TYPE;
+  auto RBegin(const KeyType &lower, const KeyType &upper) -> INDEXITERATOR_TYPE;
   auto End() -> INDEXITERATOR_TYPE;
 
   // print the B+ tree
@@ -71,13 +121,61 @@ class BPlusTree {
   // read data from file and remove one by one
   void RemoveFromFile(const std::string &file_name, Transaction *transaction = nullptr);
   // expose for test purpose
+  // return the read latched and pinned leaf page for the key, or nullptr if the tree is empty
   auto FindLeafPage(const KeyType &key, bool leftMost = false) -> Page *;
 
  private:
+  friend class IndexIterator<KeyType, ValueType, KeyComparator>;
+
+  enum class Operation { INSERT, DELETE, COMPACT };
+
+  // descend like a B-link reader, latching the leaf in write mode if {write_leaf} is set
+  auto FindLeafPageRead(const KeyType &key, bool left_most, bool write_leaf) -> Page *;
+
+  // descend like a B-link reader to the leaf holding the last key before {key}, or up to {key} if {inclusive} is
+  // set, or to the right most leaf if {key} is nullptr, reporting the low key of the leaf
+  auto FindLeafPageBefore(const KeyType *key, bool inclusive, std::optional<KeyType> *fence) -> Page *;
+
+  // helpers of the B-link readers, which hold the latch of one page at a time
+  auto FenceSide(BPlusTreePage *node, const KeyType *key, bool inclusive) const -> int;
+  auto RightLink(BPlusTreePage *node) const -> page_id_t;
+  auto FetchRootForRead(bool write_leaf) -> Page *;
+  auto FetchForRead(page_id_t page_id, bool write_leaf) -> Page *;
+  void ReleaseForRead(Page *page, bool write_leaf);
+
+  // try the operation with only the leaf write latched, return false if it has to restart pessimistically
+  auto OptimisticInsert(const KeyType &key, const ValueType &value, bool *inserted) -> bool;
+  auto OptimisticRemove(const KeyType &key) -> bool;
+
+  // descend with write latches, keeping unsafe ancestors latched in the transaction's page set
+  auto FindLeafPageForWrite(const KeyType &key, Operation op, Transaction *transaction, bool left_most = false)
+      -> Page *;
+
+  // whether the operation cannot split or underflow the node, so the latches above it can be released
+  auto IsSafe(BPlusTreePage *node, Operation op) const -> bool;
+
+  // unlatch and unpin every page in the transaction's page set, including the root latch
+  void ReleaseLatchedPages(Transaction *transaction, bool is_dirty);
+
+  // delete the pages that were emptied by a remove, after their latches were released
+  void DeletePages(Transaction *transaction);
+
+  // fetch a page of the tree, throwing an out of memory exception if the buffer pool is full
+  auto FetchPage(page_id_t page_id) -> Page *;
+
   void StartNewTree(const KeyType &key, const ValueType &value);
 
   auto InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr) -> bool;
 
+  void RemoveFromLeaf(const KeyType &key, Transaction *transaction);
+
+  // build one level of the tree bottom up from the first key and page id of each page below it,
+  // replacing {level} by the pages of the new level and recording them in {pages}
+  auto BulkLoadLeaves(const std::vector<MappingType> &pairs, double fill_factor,
+                      std::vector<std::pair<KeyType, page_id_t>> *level, std::vector<page_id_t> *pages) -> bool;
+  auto BulkLoadInternals(double fill_factor, std::vector<std::pair<KeyType, page_id_t>> *level,
+                         std::vector<page_id_t> *pages) -> bool;
+
   void InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
                         Transaction *transaction = nullptr);
 
@@ -105,11 +203,17 @@ class BPlusTree {
 
   // member variable
   std::string index_name_;
+  page_id_t header_page_id_;
   page_id_t root_page_id_;
+  // protects root_page_id_, stands for the root in the page set as a nullptr
+  ReaderWriterLatch root_latch_;
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
+  int key_width_;
   int leaf_max_size_;
   int internal_max_size_;
+  // a remove rebalances a leaf only once it holds fewer pairs than this
+  int leaf_merge_size_;
 };
 
 }  // namespace bustub
@@ -23,10 +23,28 @@ namespace bustub {
 
 #define BPLUSTREE_INDEX_TYPE BPlusTreeIndex<KeyType, ValueType, KeyComparator>
 
+/**
+ * Index on top of a B+ tree. The tree only holds unique keys, so keys that may
+ * be shared by several tuples are made unique by the RID of their tuple, which
+ * is stored behind the key bytes and compared after them. A specific (key, RID)
+ * entry is then found with a single descent, and the entries of a key are the
+ * range between the key with the smallest and with the largest RID.
+ *
+ * A key with a varchar takes the key bytes the RID leaves, and a longer key is
+ * cut off there. Keys that only differ behind the stored bytes compare equal,
+ * so a lookup returns the entries of all of them, and the caller has to check
+ * the key on the tuple.
+ *
+ * The key type has to have room for the RID behind the fixed length part of the
+ * key schema, otherwise the constructor throws.
+ */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeIndex : public Index {
  public:
-  BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager);
+  // the root page id of the tree is recorded in the given header page, throws OUT_OF_RANGE if the
+  // key type has no room for the key columns and the RID
+  BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager,
+                 page_id_t header_page_id = HEADER_PAGE_ID);
 
   void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
 
@@ -34,17 +52,58 @@ class BPlusTreeIndex : public Index {
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  auto Scan(const Tuple *lower, const Tuple *upper, Transaction *transaction) -> std::unique_ptr<IndexCursor> override;
+
+  /**
+   * Builds the index from all of its entries at once, see BPlusTree::BulkLoad.
+   *
+   * @param entries the index keys and rids of all entries, preferably ordered by key
+   * @param transaction the current transaction
+   */
+  void BulkLoad(const std::vector<std::pair<KeyType, ValueType>> &entries, Transaction *transaction);
+
   auto GetBeginIterator() -> INDEXITERATOR_TYPE;
 
+  // the iterators return the keys with the RID of the entry behind the key bytes
   auto GetBeginIterator(const KeyType &key) -> INDEXITERATOR_TYPE;
 
+  auto GetBeginIterator(const KeyType &lower, const KeyType &upper) -> INDEXITERATOR_TYPE;
+
+  auto GetReverseBeginIterator() -> INDEXITERATOR_TYPE;
+
+  auto GetReverseBeginIterator(const KeyType &lower, const KeyType &upper) -> INDEXITERATOR_TYPE;
+
   auto GetEndIterator() -> INDEXITERATOR_TYPE;
 
+ private:
+  // builds the key of an entry from a key tuple, with the rid behind the key bytes
+  auto MakeKey(const Tuple &key, RID rid) const -> KeyType;
+  // stores the rid behind the key bytes
+  void SetRid(KeyType *key, RID rid) const;
+
  protected:
+  // the number of leading key bytes the key schema can use, the RID of an entry follows them
+  int key_width_;
   // comparator for key
   KeyComparator comparator_;
   // container
   BPlusTree<KeyType, ValueType, KeyComparator> container_;
 };
 
+/**
+ * Cursor over the entries of a B+ tree index, decoding the key columns from the
+ * bytes of the keys only when asked for them.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class BPlusTreeIndexCursor : public IndexCursor {
+ public:
+  BPlusTreeIndexCursor(INDEXITERATOR_TYPE &&iterator, Schema *key_schema);
+
+  auto Next(RID *rid, std::vector<Value> *key_values) -> bool override;
+
+ private:
+  INDEXITERATOR_TYPE iterator_;
+  Schema *key_schema_;
+};
+
 }  // namespace bustub
@@ -15,6 +15,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "container/hash/extendible_hash_table.h"
@@ -39,6 +40,14 @@ class ExtendibleHashTableIndex : public Index {
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  /**
+   * Builds the index from all of its entries at once, see ExtendibleHashTable::BulkLoad.
+   *
+   * @param entries the index keys and rids of all entries
+   * @param transaction the current transaction
+   */
+  void BulkLoad(const std::vector<std::pair<KeyType, ValueType>> &entries, Transaction *transaction);
+
  protected:
   // comparator for key
   KeyComparator comparator_;
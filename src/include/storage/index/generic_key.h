@@ -12,9 +12,15 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cstring>
+#include <optional>
+#include <vector>
 
+#include "common/rid.h"
+#include "container/hash/hash_function.h"
 #include "storage/table/tuple.h"
+#include "type/type_util.h"
 #include "type/value.h"
 
 namespace bustub {
@@ -32,7 +38,7 @@ class GenericKey {
   inline void SetFromKey(const Tuple &tuple) {
     // intialize to 0
     memset(data_, 0, KeySize);
-    memcpy(data_, tuple.GetData(), tuple.GetLength());
+    memcpy(data_, tuple.GetData(), std::min(tuple.GetLength(), static_cast<uint32_t>(KeySize)));
   }
 
   // NOTE: for test purpose only
@@ -72,35 +78,223 @@ class GenericKey {
 
 /**
  * Function object returns true if lhs < rhs, used for trees
+ *
+ * The key schema is compiled into a list of column offsets and types when the
+ * comparator is constructed, and the columns are compared on the raw key bytes
+ * with the same ordering and NULL semantics as Value. Only types without a raw
+ * comparison fall back to deserializing Values.
+ *
+ * An index that allows duplicate keys stores the RID of each entry behind the
+ * key bytes. Its comparator is given the offset of that RID and breaks ties on
+ * it, so every entry has a distinct key ordered by (key, RID).
  */
 template <size_t KeySize>
 class GenericComparator {
  public:
   inline auto operator()(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) const -> int {
-    uint32_t column_count = key_schema_->GetColumnCount();
-
-    for (uint32_t i = 0; i < column_count; i++) {
-      Value lhs_value = (lhs.ToValue(key_schema_, i));
-      Value rhs_value = (rhs.ToValue(key_schema_, i));
-
-      if (lhs_value.CompareLessThan(rhs_value) == CmpBool::CmpTrue) {
-        return -1;
-      }
-      if (lhs_value.CompareGreaterThan(rhs_value) == CmpBool::CmpTrue) {
-        return 1;
+    for (const auto &column : columns_) {
+      int cmp = CompareColumn(column, lhs, rhs);
+      if (cmp != 0) {
+        return cmp;
       }
     }
+    if (rid_offset_.has_value()) {
+      return CompareRids(lhs.data_ + rid_offset_.value(), rhs.data_ + rid_offset_.value());
+    }
     // equals
     return 0;
   }
 
-  GenericComparator(const GenericComparator &other) : key_schema_{other.key_schema_} {}
+  GenericComparator(const GenericComparator &other) = default;
 
   // constructor
-  explicit GenericComparator(Schema *key_schema) : key_schema_(key_schema) {}
+  explicit GenericComparator(Schema *key_schema, std::optional<uint32_t> rid_offset = std::nullopt)
+      : key_schema_(key_schema), rid_offset_(rid_offset) {
+    uint32_t column_count = key_schema_->GetColumnCount();
+    columns_.reserve(column_count);
+    for (uint32_t i = 0; i < column_count; i++) {
+      const auto &col = key_schema_->GetColumn(i);
+      columns_.push_back({col.GetType(), col.GetOffset(), col.IsInlined(), i});
+    }
+  }
 
  private:
+  struct ColumnPlan {
+    TypeId type_;
+    uint32_t offset_;
+    bool is_inlined_;
+    uint32_t column_idx_;
+  };
+
+  template <typename T>
+  static inline auto CompareNumbers(const char *lhs, const char *rhs, T null_value) -> int {
+    T lhs_value;
+    T rhs_value;
+    memcpy(&lhs_value, lhs, sizeof(T));
+    memcpy(&rhs_value, rhs, sizeof(T));
+    // a comparison with NULL is neither less nor greater
+    if (lhs_value == null_value || rhs_value == null_value) {
+      return 0;
+    }
+    return lhs_value < rhs_value ? -1 : (rhs_value < lhs_value ? 1 : 0);
+  }
+
+  static inline auto CompareRids(const char *lhs, const char *rhs) -> int {
+    RID lhs_rid;
+    RID rhs_rid;
+    memcpy(&lhs_rid, lhs, sizeof(RID));
+    memcpy(&rhs_rid, rhs, sizeof(RID));
+    if (lhs_rid.GetPageId() != rhs_rid.GetPageId()) {
+      return lhs_rid.GetPageId() < rhs_rid.GetPageId() ? -1 : 1;
+    }
+    if (lhs_rid.GetSlotNum() != rhs_rid.GetSlotNum()) {
+      return lhs_rid.GetSlotNum() < rhs_rid.GetSlotNum() ? -1 : 1;
+    }
+    return 0;
+  }
+
+  // {lhs_room} and {rhs_room} are the key bytes from the start of each varchar on, a varchar that does
+  // not fit into them was cut off when the key was built, and only its stored characters are compared
+  static inline auto CompareVarchars(const char *lhs, int64_t lhs_room, const char *rhs, int64_t rhs_room) -> int {
+    if (lhs_room < static_cast<int64_t>(sizeof(uint32_t)) || rhs_room < static_cast<int64_t>(sizeof(uint32_t))) {
+      // cut off before its characters, which only happens behind an equal varchar that was cut off as well
+      return 0;
+    }
+    uint32_t lhs_len;
+    uint32_t rhs_len;
+    memcpy(&lhs_len, lhs, sizeof(uint32_t));
+    memcpy(&rhs_len, rhs, sizeof(uint32_t));
+    if (lhs_len == BUSTUB_VALUE_NULL || rhs_len == BUSTUB_VALUE_NULL) {
+      return 0;
+    }
+    if (lhs_len == BUSTUB_VARCHAR_MAX_LEN || rhs_len == BUSTUB_VARCHAR_MAX_LEN) {
+      return lhs_len < rhs_len ? -1 : (rhs_len < lhs_len ? 1 : 0);
+    }
+    // the serialized length counts the terminating null character
+    auto lhs_chars = std::min<int64_t>(std::max<int64_t>(lhs_len, 1) - 1, lhs_room - sizeof(uint32_t));
+    auto rhs_chars = std::min<int64_t>(std::max<int64_t>(rhs_len, 1) - 1, rhs_room - sizeof(uint32_t));
+    int cmp = TypeUtil::CompareStrings(lhs + sizeof(uint32_t), static_cast<int>(lhs_chars), rhs + sizeof(uint32_t),
+                                       static_cast<int>(rhs_chars));
+    return cmp < 0 ? -1 : (cmp > 0 ? 1 : 0);
+  }
+
+  // the number of leading bytes that hold the key, the RID of an index with duplicates follows them
+  inline auto KeyBytes() const -> int64_t { return rid_offset_.value_or(KeySize); }
+
+  inline auto ColumnData(const ColumnPlan &column, const GenericKey<KeySize> &key) const -> const char * {
+    if (column.is_inlined_) {
+      return key.data_ + column.offset_;
+    }
+    int32_t offset;
+    memcpy(&offset, key.data_ + column.offset_, sizeof(int32_t));
+    return key.data_ + offset;
+  }
+
+  inline auto CompareColumn(const ColumnPlan &column, const GenericKey<KeySize> &lhs,
+                            const GenericKey<KeySize> &rhs) const -> int {
+    const char *lhs_data = ColumnData(column, lhs);
+    const char *rhs_data = ColumnData(column, rhs);
+    switch (column.type_) {
+      case TypeId::TINYINT:
+        return CompareNumbers<int8_t>(lhs_data, rhs_data, BUSTUB_INT8_NULL);
+      case TypeId::SMALLINT:
+        return CompareNumbers<int16_t>(lhs_data, rhs_data, BUSTUB_INT16_NULL);
+      case TypeId::INTEGER:
+        return CompareNumbers<int32_t>(lhs_data, rhs_data, BUSTUB_INT32_NULL);
+      case TypeId::BIGINT:
+        return CompareNumbers<int64_t>(lhs_data, rhs_data, BUSTUB_INT64_NULL);
+      case TypeId::DECIMAL:
+        return CompareNumbers<double>(lhs_data, rhs_data, BUSTUB_DECIMAL_NULL);
+      case TypeId::TIMESTAMP:
+        return CompareNumbers<uint64_t>(lhs_data, rhs_data, BUSTUB_TIMESTAMP_NULL);
+      case TypeId::VARCHAR:
+        return CompareVarchars(lhs_data, KeyBytes() - (lhs_data - lhs.data_), rhs_data,
+                               KeyBytes() - (rhs_data - rhs.data_));
+      default:
+        break;
+    }
+    Value lhs_value = (lhs.ToValue(key_schema_, column.column_idx_));
+    Value rhs_value = (rhs.ToValue(key_schema_, column.column_idx_));
+    if (lhs_value.CompareLessThan(rhs_value) == CmpBool::CmpTrue) {
+      return -1;
+    }
+    if (lhs_value.CompareGreaterThan(rhs_value) == CmpBool::CmpTrue) {
+      return 1;
+    }
+    return 0;
+  }
+
   Schema *key_schema_;
+  // the columns of the key schema in comparison order
+  std::vector<ColumnPlan> columns_;
+  // where the RID of the entry is stored in keys of an index with duplicates
+  std::optional<uint32_t> rid_offset_;
+};
+
+/**
+ * Hash function for generic keys. Without a key schema it hashes all KeySize
+ * bytes like the primary template. Once bound to the key schema, it only hashes
+ * the bytes the schema uses, and a key of a single integer column is hashed with
+ * a 64-bit mixer instead of MurmurHash3.
+ */
+template <size_t KeySize>
+class HashFunction<GenericKey<KeySize>> {
+ public:
+  /**
+   * Specializes the hash function for keys of the given schema.
+   *
+   * @param key_schema the schema the keys are serialized with
+   */
+  void BindKeySchema(const Schema *key_schema) {
+    // uninlined columns store their data behind the fixed length part, so the
+    // whole key is hashed for them
+    used_bytes_ = KeySize;
+    if (key_schema->IsInlined()) {
+      used_bytes_ = std::min<uint32_t>(key_schema->GetLength(), KeySize);
+    }
+    integer_bytes_ = 0;
+    if (key_schema->GetColumnCount() == 1) {
+      switch (key_schema->GetColumn(0).GetType()) {
+        case TypeId::TINYINT:
+        case TypeId::SMALLINT:
+        case TypeId::INTEGER:
+        case TypeId::BIGINT:
+          integer_bytes_ = used_bytes_;
+          break;
+        default:
+          break;
+      }
+    }
+  }
+
+  /**
+   * @param key the key to be hashed
+   * @return the hashed value
+   */
+  virtual auto GetHash(GenericKey<KeySize> key) -> uint64_t {
+    if (integer_bytes_ != 0) {
+      // the key bytes past the integer are zero, so the low bytes of a 64-bit
+      // load hold the integer on little endian machines
+      uint64_t k = 0;
+      memcpy(&k, key.data_, integer_bytes_);
+      k ^= k >> 33;
+      k *= 0xff51afd7ed558ccdULL;
+      k ^= k >> 33;
+      k *= 0xc4ceb9fe1a85ec53ULL;
+      k ^= k >> 33;
+      return k;
+    }
+    uint64_t hash[2];
+    murmur3::MurmurHash3_x64_128(reinterpret_cast<const void *>(key.data_), static_cast<int>(used_bytes_), 0,
+                                 reinterpret_cast<void *>(&hash));
+    return hash[0];
+  }
+
+ private:
+  // Number of leading key bytes the hash depends on
+  uint32_t used_bytes_{KeySize};
+  // Width of a single integer key column, 0 for other keys
+  uint32_t integer_bytes_{0};
 };
 
 }  // namespace bustub
@@ -96,6 +96,25 @@ class IndexMetadata {
   Schema *key_schema_;
 };
 
+/**
+ * class IndexCursor - Returns the entries of an index one at a time
+ *
+ * A cursor may keep pages of the index pinned until it is destroyed.
+ */
+class IndexCursor {
+ public:
+  virtual ~IndexCursor() = default;
+
+  /**
+   * Advance to the next entry.
+   * @param[out] rid The RID of the entry
+   * @param[out] key_values The values of the key columns of the entry in key schema order, skipped if nullptr;
+   * only asked for keys without a varchar, which the index may have cut off
+   * @return false if there are no more entries
+   */
+  virtual auto Next(RID *rid, std::vector<Value> *key_values) -> bool = 0;
+};
+
 /////////////////////////////////////////////////////////////////////
 // Index class definition
 /////////////////////////////////////////////////////////////////////
@@ -175,6 +194,18 @@ class Index {
    */
   virtual void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) = 0;
 
+  /**
+   * Scan the entries of the index in key order, between two keys including both.
+   * Trailing columns of the bounds may be NULL, which matches every value of the column.
+   * @param lower The index key to start at, or nullptr to start at the first entry
+   * @param upper The index key to stop after, or nullptr to stop after the last entry
+   * @param transaction The transaction context
+   * @return A cursor over the entries, or nullptr if the index does not keep its keys in order
+   */
+  virtual auto Scan(const Tuple *lower, const Tuple *upper, Transaction *transaction) -> std::unique_ptr<IndexCursor> {
+    return nullptr;
+  }
+
  private:
   /** The Index structure owns its metadata */
   std::unique_ptr<IndexMetadata> metadata_;
@@ -13,18 +13,56 @@
  * For range scan of b+ tree
  */
 #pragma once
+#include <optional>
+#include <vector>
+
 #include "storage/page/b_plus_tree_leaf_page.h"
 
 namespace bustub {
 
+INDEX_TEMPLATE_ARGUMENTS
+class BPlusTree;
+
 #define INDEXITERATOR_TYPE IndexIterator<KeyType, ValueType, KeyComparator>
 
+/**
+ * Iterates the leaf pages of a B+ tree from left to right, or from right to
+ * left, optionally stopping at a bound key.
+ *
+ * The iterator never holds a latch or a pin between two calls. It copies the
+ * entries of one leaf under that leaf's read latch, so it can neither block
+ * writers nor deadlock with them, and a merge can always delete the leaves it
+ * empties.
+ *
+ * A forward iterator follows the next page id of the leaves. It continues at
+ * the high key of the leaf it is done with: if the next leaf no longer covers
+ * that key because it was merged away or passed keys to the left, the iterator
+ * descends to the key instead.
+ * Once a leaf reaches the bound, the next leaf is not read at all.
+ *
+ * Leaves do not link to their left siblings, since following such links would
+ * latch leaves from right to left against the crabbing writers. A backward
+ * iterator instead descends from the root again for the keys below the lower
+ * fence of the leaf it is done with, i.e. below the separator in front of the
+ * leaf's subtree.
+ */
 INDEX_TEMPLATE_ARGUMENTS
 class IndexIterator {
+  using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
+  using Tree = BPlusTree<KeyType, ValueType, KeyComparator>;
+
  public:
-  // you may define your own constructor based on your member variables
+  // the end iterator
   IndexIterator();
-  ~IndexIterator();  // NOLINT
+  // starts at entry {index} of {page}, a pinned and read latched leaf that the iterator releases,
+  // and stops after the last key not greater than {upper}, if given
+  IndexIterator(Tree *tree, Page *page, int index, std::optional<KeyType> upper = std::nullopt);
+  // starts at the last key not greater than {upper}, or at the last key of the tree, and moves backward,
+  // stopping after the last key not less than {lower}, if given
+  IndexIterator(Tree *tree, std::optional<KeyType> upper, std::optional<KeyType> lower);
+  IndexIterator(const IndexIterator &other) = delete;
+  IndexIterator(IndexIterator &&other) noexcept = default;
+  auto operator=(IndexIterator &&other) noexcept -> IndexIterator & = default;
 
   auto IsEnd() -> bool;
 
@@ -32,12 +70,37 @@ class IndexIterator {
 
   auto operator++() -> IndexIterator &;
 
-  auto operator==(const IndexIterator &itr) const -> bool { throw std::runtime_error("unimplemented"); }
+  auto operator==(const IndexIterator &itr) const -> bool {
+    return page_id_ == itr.page_id_ && index_ == itr.index_;
+  }
 
-  auto operator!=(const IndexIterator &itr) const -> bool { throw std::runtime_error("unimplemented"); }
+  auto operator!=(const IndexIterator &itr) const -> bool { return !(*this == itr); }
 
  private:
-  // add your own private member variables here
+  // copies the entries of a latched leaf from {index} on up to the bound and releases the leaf
+  void LoadLeaf(Page *page, int index);
+  // copies the entries before {key}, or up to {key} if {inclusive} is set, from the leaf holding them,
+  // descending again for the leaves further left as long as no entry is found
+  void LoadLeafBefore(const KeyType *key, bool inclusive);
+  // moves on to the next leaf in iteration order, or to the end
+  void NextLeaf();
+  void SetEnd();
+
+  Tree *tree_{nullptr};
+  bool reverse_{false};
+  // the last key to return, upper bound of a forward and lower bound of a backward iterator
+  std::optional<KeyType> bound_;
+  // the leaf the entries were copied from, INVALID_PAGE_ID at the end
+  page_id_t page_id_{INVALID_PAGE_ID};
+  // forward: the leaf to continue at, INVALID_PAGE_ID if there is none or it lies past the bound
+  page_id_t next_page_id_{INVALID_PAGE_ID};
+  // forward: the high key of the leaf, backward: its low key, empty at the last leaf or if it lies past the bound
+  std::optional<KeyType> fence_;
+  // position inside the leaf, so that equal positions compare equal, and of the first copied entry
+  int index_{0};
+  int offset_{0};
+  // the copied entries in iteration order
+  std::vector<MappingType> items_;
 };
 
 }  // namespace bustub
@@ -10,6 +10,7 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <optional>
 #include <queue>
 
 #include "storage/page/b_plus_tree_page.h"
@@ -17,8 +18,8 @@
 namespace bustub {
 
 #define B_PLUS_TREE_INTERNAL_PAGE_TYPE BPlusTreeInternalPage<KeyType, ValueType, KeyComparator>
-#define INTERNAL_PAGE_HEADER_SIZE 24
-#define INTERNAL_PAGE_SIZE ((PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(MappingType)))
+#define INTERNAL_PAGE_HEADER_SIZE 36
+#define INTERNAL_PAGE_SIZE ((PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE - 2 * sizeof(KeyType)) / (sizeof(MappingType)))
 /**
  * Store n indexed keys and n+1 child pointers (page_id) within internal page.
  * Pointer PAGE_ID(i) points to a subtree in which all keys K satisfy:
@@ -27,16 +28,41 @@ namespace bustub {
  * the first key always remains invalid. That is to say, any search/lookup
  * should ignore the first key.
  *
+ * Like in leaf pages, only the first KeyWidth bytes of each key are stored, and
+ * the page links to its right sibling and keeps the fence keys of its range.
+ *
  * Internal page format (keys are stored in increasing order):
- *  --------------------------------------------------------------------------
- * | HEADER | KEY(1)+PAGE_ID(1) | KEY(2)+PAGE_ID(2) | ... | KEY(n)+PAGE_ID(n) |
- *  --------------------------------------------------------------------------
+ *  ----------------------------------------------------------------------------------------------
+ * | HEADER | LOW KEY | HIGH KEY | KEY(1)+PAGE_ID(1) | KEY(2)+PAGE_ID(2) | ... | KEY(n)+PAGE_ID(n) |
+ *  ----------------------------------------------------------------------------------------------
+ *
+ *  Header format (size in byte, 36 bytes in total):
+ *  ---------------------------------------------------------------------
+ * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
+ *  ---------------------------------------------------------------------
+ *  -----------------------------------------------------------------------------
+ * | ParentPageId (4) | PageId (4) | NextPageId (4) | KeyWidth (4) | Flags (4)
+ *  -----------------------------------------------------------------------------
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeInternalPage : public BPlusTreePage {
  public:
   // must call initialize method after "create" a new node
-  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = INTERNAL_PAGE_SIZE);
+  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = INTERNAL_PAGE_SIZE,
+            int key_width = sizeof(KeyType));
+  // the number of entries that fit into a page if the first key_width bytes of each key are stored
+  static auto Capacity(int key_width) -> int;
+
+  // the right link and the fence keys, see the leaf page
+  auto GetNextPageId() const -> page_id_t;
+  void SetNextPageId(page_id_t next_page_id);
+  auto GetLowKey() const -> std::optional<KeyType>;
+  void SetLowKey(const std::optional<KeyType> &key);
+  auto GetHighKey() const -> std::optional<KeyType>;
+  void SetHighKey(const std::optional<KeyType> &key);
+  auto CompareFences(const KeyType &key, const KeyComparator &comparator, bool inclusive = true) const -> int;
+  auto IsDeleted() const -> bool;
+  void SetDeleted();
 
   auto KeyAt(int index) const -> KeyType;
   void SetKeyAt(int index, const KeyType &key);
@@ -44,6 +70,7 @@ class BPlusTreeInternalPage : public BPlusTreePage {
   auto ValueAt(int index) const -> ValueType;
 
   auto Lookup(const KeyType &key, const KeyComparator &comparator) const -> ValueType;
+  auto LookupIndex(const KeyType &key, const KeyComparator &comparator, bool inclusive = true) const -> int;
   void PopulateNewRoot(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value);
   auto InsertNodeAfter(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value) -> int;
   void Remove(int index);
@@ -57,11 +84,27 @@ class BPlusTreeInternalPage : public BPlusTreePage {
   void MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
                          BufferPoolManager *buffer_pool_manager);
 
+  // Bulk load utility method, the key of the first appended child is ignored if the page is empty
+  void AppendChildren(MappingType *items, int size, BufferPoolManager *buffer_pool_manager);
+
  private:
-  void CopyNFrom(MappingType *items, int size, BufferPoolManager *buffer_pool_manager);
+  enum Flag { HAS_LOW_KEY = 1, HAS_HIGH_KEY = 2, DELETED = 4 };
+
+  auto FenceAt(int index) -> char *;
+  auto FenceAt(int index) const -> const char *;
+  auto EntrySize() const -> size_t;
+  auto EntryAt(int index) -> char *;
+  auto EntryAt(int index) const -> const char *;
+  auto KeyRefAt(int index) const -> const KeyType &;
+  void SetValueAt(int index, const ValueType &value);
+  void CopyNFrom(const char *entries, int size, BufferPoolManager *buffer_pool_manager);
   void CopyLastFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager);
   void CopyFirstFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager);
-  // Flexible array member for page data.
-  MappingType array_[1];
+  void Adopt(const ValueType &child_page_id, BufferPoolManager *buffer_pool_manager);
+  page_id_t next_page_id_;
+  int key_width_;
+  int flags_;
+  // Flexible array member for page data, the two fence keys followed by the entries EntrySize() bytes apart.
+  char data_[1];
 };
 }  // namespace bustub
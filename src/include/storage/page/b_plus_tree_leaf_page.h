@@ -10,6 +10,7 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <optional>
 #include <utility>
 #include <vector>
 
@@ -18,39 +19,62 @@
 namespace bustub {
 
 #define B_PLUS_TREE_LEAF_PAGE_TYPE BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>
-#define LEAF_PAGE_HEADER_SIZE 28
-#define LEAF_PAGE_SIZE ((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(MappingType))
+#define LEAF_PAGE_HEADER_SIZE 36
+#define LEAF_PAGE_SIZE ((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE - 2 * sizeof(KeyType)) / sizeof(MappingType))
 
 /**
  * Store indexed key and record id(record id = page id combined with slot id,
  * see include/common/rid.h for detailed implementation) together within leaf
  * page. Only support unique key.
  *
+ * Only the first KeyWidth bytes of each key are stored, the rest of the key is
+ * zero. An index whose key schema needs fewer bytes than the key type holds
+ * fits more entries into a page.
+ *
+ * The fence keys bound the range of keys the page is responsible for, see
+ * BPlusTree. The low key is the first key of the range and the high key the
+ * first key after it, a page without a low key or high key is the first or the
+ * last page of its level.
+ *
  * Leaf page format (keys are stored in order):
- *  ----------------------------------------------------------------------
- * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
- *  ----------------------------------------------------------------------
+ *  ----------------------------------------------------------------------------------------
+ * | HEADER | LOW KEY | HIGH KEY | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
+ *  ----------------------------------------------------------------------------------------
  *
- *  Header format (size in byte, 28 bytes in total):
+ *  Header format (size in byte, 36 bytes in total):
  *  ---------------------------------------------------------------------
  * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
  *  ---------------------------------------------------------------------
- *  -----------------------------------------------
- * | ParentPageId (4) | PageId (4) | NextPageId (4)
- *  -----------------------------------------------
+ *  -----------------------------------------------------------------------------
+ * | ParentPageId (4) | PageId (4) | NextPageId (4) | KeyWidth (4) | Flags (4)
+ *  -----------------------------------------------------------------------------
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeLeafPage : public BPlusTreePage {
  public:
   // After creating a new leaf page from buffer pool, must call initialize
   // method to set default values
-  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = LEAF_PAGE_SIZE);
+  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = LEAF_PAGE_SIZE,
+            int key_width = sizeof(KeyType));
+  // the number of entries that fit into a page if the first key_width bytes of each key are stored
+  static auto Capacity(int key_width) -> int;
   // helper methods
   auto GetNextPageId() const -> page_id_t;
   void SetNextPageId(page_id_t next_page_id);
+  auto GetLowKey() const -> std::optional<KeyType>;
+  void SetLowKey(const std::optional<KeyType> &key);
+  auto GetHighKey() const -> std::optional<KeyType>;
+  void SetHighKey(const std::optional<KeyType> &key);
+  // whether the key lies left of the range of the page (-1), in it (0) or right of it (1),
+  // or the keys right before it if {inclusive} is not set
+  auto CompareFences(const KeyType &key, const KeyComparator &comparator, bool inclusive = true) const -> int;
+  // a page merged into its left sibling is marked for the readers that still hold its page id
+  auto IsDeleted() const -> bool;
+  void SetDeleted();
   auto KeyAt(int index) const -> KeyType;
   auto KeyIndex(const KeyType &key, const KeyComparator &comparator) const -> int;
-  auto GetItem(int index) -> const MappingType &;
+  auto ValueAt(int index) const -> ValueType;
+  auto GetItem(int index) const -> MappingType;
 
   // insert and delete methods
   auto Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator) -> int;
@@ -63,12 +87,26 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   void MoveFirstToEndOf(BPlusTreeLeafPage *recipient);
   void MoveLastToFrontOf(BPlusTreeLeafPage *recipient);
 
+  // Bulk load utility method, the items have to be sorted and greater than the keys of this page
+  void AppendItems(const MappingType *items, int size);
+
  private:
-  void CopyNFrom(MappingType *items, int size);
-  void CopyLastFrom(const MappingType &item);
-  void CopyFirstFrom(const MappingType &item);
+  enum Flag { HAS_LOW_KEY = 1, HAS_HIGH_KEY = 2, DELETED = 4 };
+
+  auto FenceAt(int index) -> char *;
+  auto FenceAt(int index) const -> const char *;
+  auto EntrySize() const -> size_t;
+  auto EntryAt(int index) -> char *;
+  auto EntryAt(int index) const -> const char *;
+  auto KeyRefAt(int index) const -> const KeyType &;
+  void SetItemAt(int index, const KeyType &key, const ValueType &value);
+  void CopyNFrom(const char *entries, int size);
+  void CopyLastFrom(const char *entry);
+  void CopyFirstFrom(const char *entry);
   page_id_t next_page_id_;
-  // Flexible array member for page data.
-  MappingType array_[1];
+  int key_width_;
+  int flags_;
+  // Flexible array member for page data, the two fence keys followed by the entries EntrySize() bytes apart.
+  char data_[1];
 };
 }  // namespace bustub
@@ -20,25 +20,62 @@
 #include "storage/page/hash_table_page_defs.h"
 namespace bustub {
 /**
- * Store indexed key and and value together within bucket page. Supports
- * non-unique keys.
+ * Store indexed keys and values within bucket page. Supports non-unique keys.
  *
- * Bucket page format (keys are stored in order):
- *  ----------------------------------------------------------------
- * | KEY(1) + VALUE(1) | KEY(2) + VALUE(2) | ... | KEY(n) + VALUE(n)
- *  ----------------------------------------------------------------
+ * Keys and values are kept in two separate contiguous arrays, so that a scan
+ * over the keys does not drag the values through the cache.
  *
- *  Here '+' means concatenation.
- *  The above format omits the space required for the occupied_ and
- *  readable_ arrays. More information is in storage/page/hash_table_page_defs.h.
+ * Bucket page format (slot i of both arrays forms one pair):
+ *  ------------------------------------------------------------------
+ * | KEY(1) | KEY(2) | ... | KEY(n) | VALUE(1) | VALUE(2) | ... | VALUE(n)
+ *  ------------------------------------------------------------------
  *
+ *  The above format omits the overflow page id header, the space required
+ *  for the occupied_ and readable_ arrays and the one-byte fingerprint of
+ *  every slot. More information is in storage/page/hash_table_page_defs.h.
+ *
+ *  A bucket whose keys all share the same hash bits (e.g. many duplicates of
+ *  one key) cannot be split apart, so it grows a chain of overflow pages of the
+ *  same format instead.
+ *
+ *  Lookups first compare the fingerprints of a whole group of slots at once
+ *  (SSE2/AVX2 when available), and only call the KeyComparator on the slots
+ *  whose fingerprint matches.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class HashTableBucketPage {
+#if defined(__AVX2__)
+  static constexpr uint32_t PROBE_WIDTH = 32;
+#elif defined(__SSE2__)
+  static constexpr uint32_t PROBE_WIDTH = 16;
+#else
+  static constexpr uint32_t PROBE_WIDTH = 8;
+#endif
+  static constexpr uint32_t FULL_PROBE_MASK = static_cast<uint32_t>((uint64_t{1} << PROBE_WIDTH) - 1);
+  static constexpr uint64_t FINGERPRINT_MULTIPLIER = 0x9E3779B97F4A7C15ULL;
+
  public:
   // Delete all constructor / destructor to ensure memory safety
   HashTableBucketPage() = delete;
 
+  /**
+   * Init method after creating a new bucket page. Empties the bucket and
+   * clears its overflow link.
+   */
+  void Init();
+
+  /**
+   * @return the page id of the next overflow page in this bucket's chain, or INVALID_PAGE_ID
+   */
+  auto GetOverflowPageId() const -> page_id_t;
+
+  /**
+   * Links an overflow page behind this bucket page.
+   *
+   * @param overflow_page_id the page id of the overflow page, or INVALID_PAGE_ID to end the chain
+   */
+  void SetOverflowPageId(page_id_t overflow_page_id);
+
   /**
    * Scan the bucket and collect values that have the matching key
    *
@@ -140,13 +177,37 @@ class HashTableBucketPage {
   void SetBit(char *array, uint32_t index, bool value);
   bool GetBit(const char *array, uint32_t index) const;
 
+  /**
+   * @return the one-byte fingerprint of a key, computed from its raw bytes
+   */
+  static auto Fingerprint(const KeyType &key) -> uint8_t;
+
+  /**
+   * @return a bitmask of the PROBE_WIDTH slots starting at base whose fingerprint equals fingerprint
+   */
+  auto MatchFingerprint(uint32_t base, uint8_t fingerprint) const -> uint32_t;
+
+  /**
+   * @return the PROBE_WIDTH bits of a bitmap starting at base, slot base in the lowest bit
+   */
+  auto LoadMask(const char *array, uint32_t base) const -> uint32_t;
+
+  /**
+   * @return the number of bits set in a bitmap, counted a 64-bit word at a time
+   */
+  auto CountBits(const char *array) const -> uint32_t;
+
  private:
+  // Next page of the overflow chain for keys that cannot be separated by splitting.
+  page_id_t overflow_page_id_;
   //  For more on BUCKET_ARRAY_SIZE see storage/page/hash_table_page_defs.h
   char occupied_[(BUCKET_ARRAY_SIZE - 1) / 8 + 1];
   // 0 if tombstone/brand new (never occupied), 1 otherwise.
   char readable_[(BUCKET_ARRAY_SIZE - 1) / 8 + 1];
-  // Flexible array member for page data.
-  MappingType array_[1];
+  // Fingerprint of the key in each slot, padded so that a full probe never reads past it.
+  uint8_t fingerprints_[BUCKET_FINGERPRINT_ARRAY_SIZE];
+  KeyType key_array_[BUCKET_ARRAY_SIZE];
+  ValueType value_array_[BUCKET_ARRAY_SIZE];
 };
 
 }  // namespace bustub
@@ -33,12 +33,22 @@
  */
 #define HASH_TABLE_BUCKET_TYPE HashTableBucketPage<KeyType, ValueType, KeyComparator>
 #define DIRECTORY_ARRAY_SIZE 512
+/** The directory holds 2^DIRECTORY_MAX_DEPTH = DIRECTORY_ARRAY_SIZE slots, so the global depth can never exceed it. */
+#define DIRECTORY_MAX_DEPTH 9
 
 /**
  * BUCKET_ARRAY_SIZE is the number of (key, value) pairs that can be stored in an extendible hashing bucket page.
- * It is an approximate calculation based on the size of MappingType (which is a std::pair of KeyType and ValueType).
- * For each key/value pair, we need two additional bits for occupied_ and readable_. 4 * (PAGE_SIZE - 4) / (4 * sizeof
- * (MappingType) + 1) = (PAGE_SIZE - 4)/(sizeof (MappingType) + 0.25) because 0.25 bytes = 2 bits is the space required
- * to maintain the occupied and readable flags for a key value pair.
+ * Keys and values live in separate arrays, so each pair takes sizeof (KeyType) + sizeof (ValueType) bytes without the
+ * padding of a std::pair. For each key/value pair, we need two additional bits for occupied_ and readable_ and one byte
+ * for its fingerprint. 4 * (PAGE_SIZE - 64) / (4 * (sizeof (KeyType) + sizeof (ValueType)) + 5) = (PAGE_SIZE - 64) /
+ * (sizeof (KeyType) + sizeof (ValueType) + 1.25) because 0.25 bytes = 2 bits is the space required to maintain the
+ * occupied and readable flags for a key value pair. The 64 reserved bytes cover the overflow page id, the rounding of
+ * the bitmaps, the padding of the fingerprint array and the alignment of the two arrays.
  */
-#define BUCKET_ARRAY_SIZE (4 * PAGE_SIZE / (4 * sizeof(MappingType) + 1))
+#define BUCKET_ARRAY_SIZE (4 * (PAGE_SIZE - 64) / (4 * (sizeof(KeyType) + sizeof(ValueType)) + 5))
+
+/**
+ * The fingerprint array is rounded up to a multiple of 32 slots so that a SIMD probe of a whole group never reads
+ * past its end. The rounding does not depend on the probe width, so the page layout is the same for every build.
+ */
+#define BUCKET_FINGERPRINT_ARRAY_SIZE (((BUCKET_ARRAY_SIZE - 1) / 32 + 1) * 32)
@@ -12,6 +12,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
 #include "recovery/log_manager.h"
 #include "storage/page/table_page.h"
@@ -99,6 +101,28 @@ class TableHeap {
    */
   auto GetTuple(const RID &rid, Tuple *tuple, Transaction *txn) -> bool;
 
+  /**
+   * Read many tuples from the table. The pages are visited in page id order,
+   * and each page is fetched and latched once for all of its tuples.
+   * @param rids rids of the tuples to read, in any order
+   * @param[out] tuples the tuples, at the positions of their rids
+   * @param[out] found whether each read was successful, at the positions of the rids
+   * @param txn transaction performing the read
+   * @return false if a page could not be fetched, in which case the transaction is aborted
+   */
+  auto GetTuples(const std::vector<RID> &rids, std::vector<Tuple> *tuples, std::vector<bool> *found,
+                 Transaction *txn) -> bool;
+
+  /**
+   * List the tuples of one page of the table, e.g. to scan the table a page at a time.
+   * @param page_id id of the page to list
+   * @param[out] rids the rids of the tuples on the page that are not deleted, appended in slot order
+   * @param[out] next_page_id the id of the page after it, or INVALID_PAGE_ID for the last page
+   * @param txn transaction performing the read
+   * @return false if the page could not be fetched, in which case the transaction is aborted
+   */
+  auto GetPageRids(page_id_t page_id, std::vector<RID> *rids, page_id_t *next_page_id, Transaction *txn) -> bool;
+
   /** @return the begin iterator of this table */
   auto Begin(Transaction *txn) -> TableIterator;
 
@@ -9,7 +9,11 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <numeric>
+#include <optional>
 #include <string>
+#include <type_traits>
 
 #include "common/exception.h"
 #include "common/logger.h"
@@ -18,21 +22,43 @@
 #include "storage/page/header_page.h"
 
 namespace bustub {
+
+/*
+ * Split count items into groups of about target items, where no group is
+ * smaller than min_size unless there is only one group.
+ */
+static auto BulkLoadGroupSizes(int count, int target, int min_size) -> std::vector<int> {
+  int groups = (count + target - 1) / target;
+  groups = std::max(1, std::min(groups, count / std::max(1, min_size)));
+  std::vector<int> sizes(groups, count / groups);
+  for (int i = 0; i < count % groups; i++) {
+    sizes[i]++;
+  }
+  return sizes;
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_TYPE::BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                          int leaf_max_size, int internal_max_size)
+                          int leaf_max_size, int internal_max_size, int key_width, double merge_fill_factor,
+                          page_id_t header_page_id)
     : index_name_(std::move(name)),
+      header_page_id_(header_page_id),
       root_page_id_(INVALID_PAGE_ID),
       buffer_pool_manager_(buffer_pool_manager),
       comparator_(comparator),
-      leaf_max_size_(leaf_max_size),
-      internal_max_size_(internal_max_size) {}
+      key_width_(key_width),
+      leaf_max_size_(std::min(leaf_max_size, LeafPage::Capacity(key_width))),
+      // an internal page overflows by one entry before it is split
+      internal_max_size_(std::min(internal_max_size, InternalPage::Capacity(key_width) - 1)),
+      // never above the min size of a leaf, and an emptied leaf is always merged
+      leaf_merge_size_(std::clamp(static_cast<int>(merge_fill_factor * leaf_max_size_), 1,
+                                  std::max(1, leaf_max_size_ / 2))) {}
 
 /*
  * Helper function to decide whether current b+tree is empty
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::IsEmpty() const -> bool { return true; }
+auto BPLUSTREE_TYPE::IsEmpty() const -> bool { return root_page_id_ == INVALID_PAGE_ID; }
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
@@ -43,7 +69,186 @@ auto BPLUSTREE_TYPE::IsEmpty() const -> bool { return true; }
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction) -> bool {
-  return false;
+  Page *page = FindLeafPage(key);
+  if (page == nullptr) {
+    return false;
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  ValueType value;
+  bool found = leaf->Lookup(key, &value, comparator_);
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  if (found) {
+    result->push_back(value);
+  }
+  return found;
+}
+
+/*
+ * Look up the keys in key order. A leaf stays read latched while the next keys
+ * are below its high key, the keys in its range cannot move to another page
+ * before the latch is released.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::BatchLookup(const std::vector<KeyType> &keys, std::vector<std::optional<ValueType>> *results,
+                                 Transaction *transaction) {
+  results->assign(keys.size(), std::nullopt);
+  std::vector<size_t> order(keys.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [this, &keys](size_t a, size_t b) { return comparator_(keys[a], keys[b]) < 0; });
+
+  size_t next = 0;
+  while (next < order.size()) {
+    Page *page = FindLeafPageRead(keys[order[next]], false, false);
+    if (page == nullptr) {
+      return;
+    }
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    do {
+      ValueType value;
+      if (leaf->Lookup(keys[order[next]], &value, comparator_)) {
+        (*results)[order[next]] = value;
+      }
+      next++;
+    } while (next < order.size() && leaf->CompareFences(keys[order[next]], comparator_) == 0);
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  }
+}
+
+/*****************************************************************************
+ * BULK LOADING
+ *****************************************************************************/
+/*
+ * Build the tree bottom up: the leaves are filled one after another and linked,
+ * then each internal level is built from the first keys of the level below. The
+ * pages of a level are fenced by the first keys of their neighbors,
+ * until a level consists of a single page, the root. Every page is written once
+ * and no page is ever split.
+ * A leaf holds at most max size - 1 pairs and an internal page at most max size
+ * children before they split, the fill factor is relative to these.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::BulkLoad(const std::vector<MappingType> &pairs, Transaction *transaction, double fill_factor)
+    -> bool {
+  root_latch_.WLock();
+  if (root_page_id_ != INVALID_PAGE_ID) {
+    root_latch_.WUnlock();
+    bool ok = true;
+    for (const auto &pair : pairs) {
+      ok = Insert(pair.first, pair.second, transaction) && ok;
+    }
+    return ok;
+  }
+  if (pairs.empty()) {
+    root_latch_.WUnlock();
+    return true;
+  }
+
+  auto less = [this](const MappingType &a, const MappingType &b) { return comparator_(a.first, b.first) < 0; };
+  auto equal = [this](const MappingType &a, const MappingType &b) { return comparator_(a.first, b.first) == 0; };
+  std::vector<MappingType> sorted;
+  const std::vector<MappingType> *ordered = &pairs;
+  if (std::adjacent_find(pairs.begin(), pairs.end(), [&less](const MappingType &a, const MappingType &b) {
+        return !less(a, b);
+      }) != pairs.end()) {
+    sorted = pairs;
+    std::stable_sort(sorted.begin(), sorted.end(), less);
+    sorted.erase(std::unique(sorted.begin(), sorted.end(), equal), sorted.end());
+    ordered = &sorted;
+  }
+
+  std::vector<std::pair<KeyType, page_id_t>> level;
+  std::vector<page_id_t> pages;
+  bool ok = BulkLoadLeaves(*ordered, fill_factor, &level, &pages);
+  while (ok && level.size() > 1) {
+    ok = BulkLoadInternals(fill_factor, &level, &pages);
+  }
+  if (!ok) {
+    for (page_id_t page_id : pages) {
+      buffer_pool_manager_->DeletePage(page_id);
+    }
+    root_latch_.WUnlock();
+    return false;
+  }
+  root_page_id_ = level[0].second;
+  UpdateRootPageId(1);
+  root_latch_.WUnlock();
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::BulkLoadLeaves(const std::vector<MappingType> &pairs, double fill_factor,
+                                    std::vector<std::pair<KeyType, page_id_t>> *level, std::vector<page_id_t> *pages)
+    -> bool {
+  int capacity = leaf_max_size_ - 1;
+  int min_size = leaf_max_size_ / 2;
+  int target = std::clamp(static_cast<int>(fill_factor * capacity), std::max(1, min_size), capacity);
+  LeafPage *prev_leaf = nullptr;
+  int offset = 0;
+  for (int size : BulkLoadGroupSizes(static_cast<int>(pairs.size()), target, min_size)) {
+    page_id_t page_id;
+    Page *page = buffer_pool_manager_->NewPage(&page_id);
+    if (page == nullptr) {
+      if (prev_leaf != nullptr) {
+        buffer_pool_manager_->UnpinPage(prev_leaf->GetPageId(), true);
+      }
+      return false;
+    }
+    pages->push_back(page_id);
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    leaf->Init(page_id, INVALID_PAGE_ID, leaf_max_size_, key_width_);
+    leaf->AppendItems(pairs.data() + offset, size);
+    level->emplace_back(leaf->KeyAt(0), page_id);
+    offset += size;
+    if (prev_leaf != nullptr) {
+      leaf->SetLowKey(leaf->KeyAt(0));
+      prev_leaf->SetHighKey(leaf->KeyAt(0));
+      prev_leaf->SetNextPageId(page_id);
+      buffer_pool_manager_->UnpinPage(prev_leaf->GetPageId(), true);
+    }
+    prev_leaf = leaf;
+  }
+  buffer_pool_manager_->UnpinPage(prev_leaf->GetPageId(), true);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::BulkLoadInternals(double fill_factor, std::vector<std::pair<KeyType, page_id_t>> *level,
+                                       std::vector<page_id_t> *pages) -> bool {
+  int capacity = internal_max_size_;
+  int min_size = (internal_max_size_ + 1) / 2;
+  int target = std::clamp(static_cast<int>(fill_factor * capacity), std::max(2, min_size), capacity);
+  std::vector<std::pair<KeyType, page_id_t>> parents;
+  InternalPage *prev_internal = nullptr;
+  int offset = 0;
+  for (int size : BulkLoadGroupSizes(static_cast<int>(level->size()), target, min_size)) {
+    page_id_t page_id;
+    Page *page = buffer_pool_manager_->NewPage(&page_id);
+    if (page == nullptr) {
+      if (prev_internal != nullptr) {
+        buffer_pool_manager_->UnpinPage(prev_internal->GetPageId(), true);
+      }
+      return false;
+    }
+    pages->push_back(page_id);
+    auto *internal = reinterpret_cast<InternalPage *>(page->GetData());
+    internal->Init(page_id, INVALID_PAGE_ID, internal_max_size_, key_width_);
+    internal->AppendChildren(level->data() + offset, size, buffer_pool_manager_);
+    parents.emplace_back(internal->KeyAt(0), page_id);
+    offset += size;
+    if (prev_internal != nullptr) {
+      internal->SetLowKey(internal->KeyAt(0));
+      prev_internal->SetHighKey(internal->KeyAt(0));
+      prev_internal->SetNextPageId(page_id);
+      buffer_pool_manager_->UnpinPage(prev_internal->GetPageId(), true);
+    }
+    prev_internal = internal;
+  }
+  buffer_pool_manager_->UnpinPage(prev_internal->GetPageId(), true);
+  *level = std::move(parents);
+  return true;
 }
 
 /*****************************************************************************
@@ -58,8 +263,94 @@ auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) -> bool {
-  return false;
+  bool inserted;
+  if (OptimisticInsert(key, value, &inserted)) {
+    return inserted;
+  }
+  // latch crabbing keeps the latched pages in the page set of a transaction
+  std::optional<Transaction> scratch;
+  if (transaction == nullptr) {
+    transaction = &scratch.emplace(INVALID_TXN_ID);
+  }
+  return InsertIntoLeaf(key, value, transaction);
 }
+/*
+ * Insert the pairs in key order. Like OptimisticInsert, a leaf is reached with
+ * read latches and write latched, and it takes every following pair below its
+ * high key until one of them would split it. That pair is inserted with
+ * write latches from the root, and the next pair descends again.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::BatchInsert(const std::vector<MappingType> &pairs, Transaction *transaction) -> int {
+  std::vector<MappingType> sorted(pairs);
+  std::stable_sort(sorted.begin(), sorted.end(),
+                   [this](const MappingType &a, const MappingType &b) { return comparator_(a.first, b.first) < 0; });
+  // latch crabbing keeps the latched pages in the page set of a transaction
+  std::optional<Transaction> scratch;
+  if (transaction == nullptr) {
+    transaction = &scratch.emplace(INVALID_TXN_ID);
+  }
+
+  int inserted = 0;
+  size_t next = 0;
+  while (next < sorted.size()) {
+    Page *page = FindLeafPageRead(sorted[next].first, false, true);
+    bool split = page == nullptr;
+    if (page != nullptr) {
+      auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+      bool dirty = false;
+      do {
+        ValueType existing;
+        if (!leaf->Lookup(sorted[next].first, &existing, comparator_)) {
+          if (!IsSafe(leaf, Operation::INSERT)) {
+            split = true;
+            break;
+          }
+          leaf->Insert(sorted[next].first, sorted[next].second, comparator_);
+          dirty = true;
+          inserted++;
+        }
+        next++;
+      } while (next < sorted.size() && leaf->CompareFences(sorted[next].first, comparator_) == 0);
+      page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), dirty);
+    }
+    if (split) {
+      inserted += InsertIntoLeaf(sorted[next].first, sorted[next].second, transaction) ? 1 : 0;
+      next++;
+    }
+  }
+  return inserted;
+}
+
+/*
+ * Insert into a leaf that is reached with read latches only and latched in
+ * write mode. This is enough unless the leaf has to split, or the tree is empty.
+ * @return: false means nothing was done and the insert has to restart with
+ * write latches from the root
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::OptimisticInsert(const KeyType &key, const ValueType &value, bool *inserted) -> bool {
+  Page *page = FindLeafPageRead(key, false, true);
+  if (page == nullptr) {
+    return false;
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  ValueType existing;
+  bool done = true;
+  if (leaf->Lookup(key, &existing, comparator_)) {
+    *inserted = false;
+  } else if (IsSafe(leaf, Operation::INSERT)) {
+    leaf->Insert(key, value, comparator_);
+    *inserted = true;
+  } else {
+    done = false;
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), done && *inserted);
+  return done;
+}
+
 /*
  * Insert constant key & value pair into an empty tree
  * User needs to first ask for new page from buffer pool manager(NOTICE: throw
@@ -67,7 +358,19 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
  * tree's root page id and insert entry directly into leaf page.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {}
+void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
+  page_id_t page_id;
+  Page *page = buffer_pool_manager_->NewPage(&page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate the root page");
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  leaf->Init(page_id, INVALID_PAGE_ID, leaf_max_size_, key_width_);
+  leaf->Insert(key, value, comparator_);
+  root_page_id_ = page_id;
+  UpdateRootPageId(1);
+  buffer_pool_manager_->UnpinPage(page_id, true);
+}
 
 /*
  * Insert constant key & value pair into leaf page
@@ -79,7 +382,26 @@ void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {}
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction) -> bool {
-  return false;
+  Page *page = FindLeafPageForWrite(key, Operation::INSERT, transaction);
+  if (page == nullptr) {
+    // the root latch is still held, nobody else can start the tree
+    StartNewTree(key, value);
+    ReleaseLatchedPages(transaction, true);
+    return true;
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  int size = leaf->GetSize();
+  if (leaf->Insert(key, value, comparator_) == size) {
+    ReleaseLatchedPages(transaction, false);
+    return false;
+  }
+  if (leaf->GetSize() >= leaf->GetMaxSize()) {
+    LeafPage *new_leaf = Split(leaf);
+    InsertIntoParent(leaf, new_leaf->KeyAt(0), new_leaf, transaction);
+    buffer_pool_manager_->UnpinPage(new_leaf->GetPageId(), true);
+  }
+  ReleaseLatchedPages(transaction, true);
+  return true;
 }
 
 /*
@@ -92,7 +414,27 @@ auto BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
 auto BPLUSTREE_TYPE::Split(N *node) -> N * {
-  return nullptr;
+  page_id_t page_id;
+  Page *page = buffer_pool_manager_->NewPage(&page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a page to split into");
+  }
+  auto *new_node = reinterpret_cast<N *>(page->GetData());
+  if constexpr (std::is_same_v<N, LeafPage>) {
+    new_node->Init(page_id, node->GetParentPageId(), leaf_max_size_, key_width_);
+    node->MoveHalfTo(new_node);
+  } else {
+    new_node->Init(page_id, node->GetParentPageId(), internal_max_size_, key_width_);
+    node->MoveHalfTo(new_node, buffer_pool_manager_);
+  }
+  // the new page takes over the upper part of the range, readers that miss it move right
+  KeyType separator = new_node->KeyAt(0);
+  new_node->SetLowKey(separator);
+  new_node->SetHighKey(node->GetHighKey());
+  new_node->SetNextPageId(node->GetNextPageId());
+  node->SetHighKey(separator);
+  node->SetNextPageId(page_id);
+  return new_node;
 }
 
 /*
@@ -106,7 +448,36 @@ auto BPLUSTREE_TYPE::Split(N *node) -> N * {
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
-                                      Transaction *transaction) {}
+                                      Transaction *transaction) {
+  if (old_node->IsRootPage()) {
+    // an unsafe root keeps the root latch in the page set
+    page_id_t root_page_id;
+    Page *page = buffer_pool_manager_->NewPage(&root_page_id);
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a new root page");
+    }
+    auto *root = reinterpret_cast<InternalPage *>(page->GetData());
+    root->Init(root_page_id, INVALID_PAGE_ID, internal_max_size_, key_width_);
+    root->PopulateNewRoot(old_node->GetPageId(), key, new_node->GetPageId());
+    old_node->SetParentPageId(root_page_id);
+    new_node->SetParentPageId(root_page_id);
+    root_page_id_ = root_page_id;
+    UpdateRootPageId(0);
+    buffer_pool_manager_->UnpinPage(root_page_id, true);
+    return;
+  }
+
+  // the parent is unsafe, so it is still latched in the page set
+  Page *parent_page = FetchPage(old_node->GetParentPageId());
+  auto *parent = reinterpret_cast<InternalPage *>(parent_page->GetData());
+  parent->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
+  if (parent->GetSize() > parent->GetMaxSize()) {
+    InternalPage *new_parent = Split(parent);
+    InsertIntoParent(parent, new_parent->KeyAt(0), new_parent, transaction);
+    buffer_pool_manager_->UnpinPage(new_parent->GetPageId(), true);
+  }
+  buffer_pool_manager_->UnpinPage(parent->GetPageId(), true);
+}
 
 /*****************************************************************************
  * REMOVE
@@ -119,7 +490,119 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
  * necessary.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {}
+void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
+  if (OptimisticRemove(key)) {
+    return;
+  }
+  // latch crabbing keeps the latched pages in the page set of a transaction
+  std::optional<Transaction> scratch;
+  if (transaction == nullptr) {
+    transaction = &scratch.emplace(INVALID_TXN_ID);
+  }
+  RemoveFromLeaf(key, transaction);
+}
+
+/*
+ * Remove from a leaf that is reached with read latches only and latched in
+ * write mode. This is enough unless the leaf would underflow.
+ * @return: false means nothing was done and the remove has to restart with
+ * write latches from the root
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::OptimisticRemove(const KeyType &key) -> bool {
+  Page *page = FindLeafPageRead(key, false, true);
+  if (page == nullptr) {
+    return true;
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  ValueType existing;
+  bool found = leaf->Lookup(key, &existing, comparator_);
+  bool done = !found || IsSafe(leaf, Operation::DELETE);
+  if (found && done) {
+    leaf->RemoveAndDeleteRecord(key, comparator_);
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), found && done);
+  return done;
+}
+
+/*
+ * Remove with write latches from the root, merging or redistributing the
+ * pages that underflow.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RemoveFromLeaf(const KeyType &key, Transaction *transaction) {
+  Page *page = FindLeafPageForWrite(key, Operation::DELETE, transaction);
+  if (page == nullptr) {
+    ReleaseLatchedPages(transaction, false);
+    return;
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  int size = leaf->GetSize();
+  if (leaf->RemoveAndDeleteRecord(key, comparator_) == size) {
+    ReleaseLatchedPages(transaction, false);
+    return;
+  }
+  // an underfull leaf is left alone until it drops below the merge size, Compact merges it later
+  if ((leaf->IsRootPage() || leaf->GetSize() < leaf_merge_size_) && CoalesceOrRedistribute(leaf, transaction)) {
+    transaction->AddIntoDeletedPageSet(leaf->GetPageId());
+  }
+  ReleaseLatchedPages(transaction, true);
+  DeletePages(transaction);
+}
+
+/*
+ * Merge or redistribute every leaf that removes left underfull, walking the
+ * leaves from left to right. A leaf is only looked at with a read latch, and
+ * the pages around an underfull leaf are latched with write latches from the
+ * root like for a remove, so the pass can run alongside any other operation.
+ * The walk keeps the low key of the next leaf instead of a page id, as the
+ * leaves may be merged or split meanwhile.
+ * @return: the number of pages that were deleted
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::Compact(Transaction *transaction) -> int {
+  std::optional<Transaction> scratch;
+  if (transaction == nullptr) {
+    transaction = &scratch.emplace(INVALID_TXN_ID);
+  }
+  int deleted = 0;
+  std::optional<KeyType> cursor;
+  KeyType left_most_key{};
+  while (true) {
+    Page *page = FindLeafPageRead(cursor.value_or(left_most_key), !cursor.has_value(), false);
+    if (page == nullptr) {
+      break;
+    }
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    bool underfull = !leaf->IsRootPage() && leaf->GetSize() < leaf->GetMinSize();
+    std::optional<KeyType> high_key = leaf->GetHighKey();
+    ReleaseForRead(page, false);
+
+    if (underfull) {
+      // check again under the write latch, and look at the same place again afterwards, as the leaf may have
+      // taken over a sibling that is still too small
+      page = FindLeafPageForWrite(cursor.value_or(left_most_key), Operation::COMPACT, transaction,
+                                  !cursor.has_value());
+      leaf = page == nullptr ? nullptr : reinterpret_cast<LeafPage *>(page->GetData());
+      bool changed = leaf != nullptr && !leaf->IsRootPage() && leaf->GetSize() < leaf->GetMinSize();
+      if (changed && CoalesceOrRedistribute(leaf, transaction)) {
+        transaction->AddIntoDeletedPageSet(leaf->GetPageId());
+      }
+      ReleaseLatchedPages(transaction, changed);
+      deleted += static_cast<int>(transaction->GetDeletedPageSet()->size());
+      DeletePages(transaction);
+      if (changed) {
+        continue;
+      }
+    }
+    if (!high_key.has_value()) {
+      break;
+    }
+    cursor = high_key;
+  }
+  return deleted;
+}
 
 /*
  * User needs to first find the sibling of input page. If sibling's size + input
@@ -131,7 +614,44 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {}
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
 auto BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) -> bool {
-  return false;
+  if (node->IsRootPage()) {
+    return AdjustRoot(node);
+  }
+  if (node->GetSize() >= node->GetMinSize()) {
+    return false;
+  }
+
+  // the parent is unsafe, so it is still latched in the page set
+  Page *parent_page = FetchPage(node->GetParentPageId());
+  auto *parent = reinterpret_cast<InternalPage *>(parent_page->GetData());
+  int index = parent->ValueIndex(node->GetPageId());
+  page_id_t sibling_page_id = parent->ValueAt(index == 0 ? 1 : index - 1);
+  Page *sibling_page = FetchPage(sibling_page_id);
+  sibling_page->WLatch();
+  auto *sibling = reinterpret_cast<N *>(sibling_page->GetData());
+
+  // a leaf splits as soon as it is full, so merged leaves have to stay below the max size
+  int merged_size = node->GetSize() + sibling->GetSize();
+  bool node_deleted = false;
+  if (node->IsLeafPage() ? merged_size < node->GetMaxSize() : merged_size <= node->GetMaxSize()) {
+    // always merge the right page into the left one
+    N *left = index == 0 ? node : sibling;
+    N *right = index == 0 ? sibling : node;
+    if (Coalesce(&left, &right, &parent, index == 0 ? 1 : index, transaction)) {
+      transaction->AddIntoDeletedPageSet(parent->GetPageId());
+    }
+    if (index == 0) {
+      transaction->AddIntoDeletedPageSet(sibling_page_id);
+    } else {
+      node_deleted = true;
+    }
+  } else {
+    Redistribute(sibling, node, index);
+  }
+  sibling_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(sibling_page_id, true);
+  buffer_pool_manager_->UnpinPage(parent->GetPageId(), true);
+  return node_deleted;
 }
 
 /*
@@ -151,7 +671,17 @@ template <typename N>
 auto BPLUSTREE_TYPE::Coalesce(N **neighbor_node, N **node,
                               BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> **parent, int index,
                               Transaction *transaction) -> bool {
-  return false;
+  if constexpr (std::is_same_v<N, LeafPage>) {
+    (*node)->MoveAllTo(*neighbor_node);
+  } else {
+    (*node)->MoveAllTo(*neighbor_node, (*parent)->KeyAt(index), buffer_pool_manager_);
+  }
+  // readers that still head for the right page find it deleted and restart
+  (*neighbor_node)->SetHighKey((*node)->GetHighKey());
+  (*neighbor_node)->SetNextPageId((*node)->GetNextPageId());
+  (*node)->SetDeleted();
+  (*parent)->Remove(index);
+  return CoalesceOrRedistribute(*parent, transaction);
 }
 
 /*
@@ -165,7 +695,30 @@ auto BPLUSTREE_TYPE::Coalesce(N **neighbor_node, N **node,
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
-void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {}
+void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {
+  Page *parent_page = FetchPage(node->GetParentPageId());
+  auto *parent = reinterpret_cast<InternalPage *>(parent_page->GetData());
+  if (index == 0) {
+    if constexpr (std::is_same_v<N, LeafPage>) {
+      neighbor_node->MoveFirstToEndOf(node);
+    } else {
+      neighbor_node->MoveFirstToEndOf(node, parent->KeyAt(1), buffer_pool_manager_);
+    }
+    parent->SetKeyAt(1, neighbor_node->KeyAt(0));
+    node->SetHighKey(neighbor_node->KeyAt(0));
+    neighbor_node->SetLowKey(neighbor_node->KeyAt(0));
+  } else {
+    if constexpr (std::is_same_v<N, LeafPage>) {
+      neighbor_node->MoveLastToFrontOf(node);
+    } else {
+      neighbor_node->MoveLastToFrontOf(node, parent->KeyAt(index), buffer_pool_manager_);
+    }
+    parent->SetKeyAt(index, node->KeyAt(0));
+    neighbor_node->SetHighKey(node->KeyAt(0));
+    node->SetLowKey(node->KeyAt(0));
+  }
+  buffer_pool_manager_->UnpinPage(parent->GetPageId(), true);
+}
 /*
  * Update root page if necessary
  * NOTE: size of root page can be less than min size and this method is only
@@ -177,7 +730,29 @@ void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {}
  * happend
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) -> bool { return false; }
+auto BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) -> bool {
+  // an unsafe root keeps the root latch in the page set
+  if (old_root_node->IsLeafPage()) {
+    if (old_root_node->GetSize() > 0) {
+      return false;
+    }
+    reinterpret_cast<LeafPage *>(old_root_node)->SetDeleted();
+    root_page_id_ = INVALID_PAGE_ID;
+    UpdateRootPageId(0);
+    return true;
+  }
+  if (old_root_node->GetSize() > 1) {
+    return false;
+  }
+  reinterpret_cast<InternalPage *>(old_root_node)->SetDeleted();
+  page_id_t child_page_id = reinterpret_cast<InternalPage *>(old_root_node)->RemoveAndReturnOnlyChild();
+  Page *child_page = FetchPage(child_page_id);
+  reinterpret_cast<BPlusTreePage *>(child_page->GetData())->SetParentPageId(INVALID_PAGE_ID);
+  buffer_pool_manager_->UnpinPage(child_page_id, true);
+  root_page_id_ = child_page_id;
+  UpdateRootPageId(0);
+  return true;
+}
 
 /*****************************************************************************
  * INDEX ITERATOR
@@ -188,7 +763,9 @@ auto BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) -> bool { return f
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE { return INDEXITERATOR_TYPE(); }
+auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE {
+  return INDEXITERATOR_TYPE(this, FindLeafPage(KeyType(), true), 0);
+}
 
 /*
  * Input parameter is low key, find the leaf page that contains the input key
@@ -196,7 +773,34 @@ auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE { return INDEXITERATOR_TYPE()
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE { return INDEXITERATOR_TYPE(); }
+auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
+  Page *page = FindLeafPage(key);
+  int index = page == nullptr ? 0 : reinterpret_cast<LeafPage *>(page->GetData())->KeyIndex(key, comparator_);
+  return INDEXITERATOR_TYPE(this, page, index);
+}
+
+/*
+ * Input parameters are the low and the high key, the iterator starts like
+ * Begin(lower) and ends after the last key not greater than upper
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::Begin(const KeyType &lower, const KeyType &upper) -> INDEXITERATOR_TYPE {
+  Page *page = FindLeafPage(lower);
+  int index = page == nullptr ? 0 : reinterpret_cast<LeafPage *>(page->GetData())->KeyIndex(lower, comparator_);
+  return INDEXITERATOR_TYPE(this, page, index, upper);
+}
+
+/*
+ * Construct an index iterator that walks the tree backward, from the last key
+ * or from the last key not greater than upper down to lower
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::RBegin() -> INDEXITERATOR_TYPE { return INDEXITERATOR_TYPE(this, std::nullopt, std::nullopt); }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::RBegin(const KeyType &lower, const KeyType &upper) -> INDEXITERATOR_TYPE {
+  return INDEXITERATOR_TYPE(this, upper, lower);
+}
 
 /*
  * Input parameter is void, construct an index iterator representing the end
@@ -212,31 +816,265 @@ auto BPLUSTREE_TYPE::End() -> INDEXITERATOR_TYPE { return INDEXITERATOR_TYPE();
 /*
  * Find leaf page containing particular key, if leftMost flag == true, find
  * the left most leaf page
+ * The returned page is pinned and read latched, the caller releases both.
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost) -> Page * {
-  throw Exception(ExceptionType::NOT_IMPLEMENTED, "Implement this for test");
+  return FindLeafPageRead(key, leftMost, false);
+}
+
+/*
+ * Descend like a B-link reader, latching only one page at a time. A page that
+ * was split after the reader left its parent passed the keys right of the split
+ * on to its new right sibling, so a key that is not below the high key of the
+ * page is followed through the right link. If the key is below the low key,
+ * the page lost it to its left sibling, or the page was merged into the left
+ * sibling and is marked deleted. The reader then restarts from the root.
+ * Page ids are never reused and a deleted page is written out with its mark,
+ * so a reader that still holds the id of a deleted page always finds the mark.
+ * The leaf is latched in write mode if write_leaf is set.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FindLeafPageRead(const KeyType &key, bool left_most, bool write_leaf) -> Page * {
+  Page *page = FetchRootForRead(write_leaf);
+  while (page != nullptr) {
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    int side = FenceSide(node, left_most ? nullptr : &key, true);
+    if (side == 0 && node->IsLeafPage()) {
+      return page;
+    }
+    page_id_t next_page_id = INVALID_PAGE_ID;
+    if (side > 0) {
+      next_page_id = RightLink(node);
+    } else if (side == 0) {
+      auto *internal = reinterpret_cast<InternalPage *>(node);
+      next_page_id = left_most ? internal->ValueAt(0) : internal->Lookup(key, comparator_);
+    }
+    ReleaseForRead(page, write_leaf);
+    page = side < 0 ? FetchRootForRead(write_leaf) : FetchForRead(next_page_id, write_leaf);
+  }
+  return nullptr;
 }
 
 /*
- * Update/Insert root page id in header page(where page_id = 0, header_page is
- * defined under include/page/header_page.h)
+ * Descend like FindLeafPageRead, but towards the keys before the input key,
+ * to the right most leaf if it is nullptr. Every key left of the returned leaf
+ * is less than its low key, which is reported as the fence.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FindLeafPageBefore(const KeyType *key, bool inclusive, std::optional<KeyType> *fence) -> Page * {
+  fence->reset();
+  Page *page = FetchRootForRead(false);
+  while (page != nullptr) {
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    // the keys before a nullptr key are the keys up to the last one
+    int side = FenceSide(node, key, inclusive && key != nullptr);
+    if (side == 0 && node->IsLeafPage()) {
+      *fence = reinterpret_cast<LeafPage *>(node)->GetLowKey();
+      return page;
+    }
+    page_id_t next_page_id = INVALID_PAGE_ID;
+    if (side > 0) {
+      next_page_id = RightLink(node);
+    } else if (side == 0) {
+      auto *internal = reinterpret_cast<InternalPage *>(node);
+      int index = key == nullptr ? internal->GetSize() - 1 : internal->LookupIndex(*key, comparator_, inclusive);
+      next_page_id = internal->ValueAt(index);
+    }
+    ReleaseForRead(page, false);
+    page = side < 0 ? FetchRootForRead(false) : FetchForRead(next_page_id, false);
+  }
+  return nullptr;
+}
+
+/*
+ * Where the key lies relative to the range of a page: -1 if the reader has to
+ * restart from the root, 0 if the page covers it, 1 if it lies further right.
+ * A nullptr key stands for the first key, or for the keys after the last one
+ * if {inclusive} is not set.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FenceSide(BPlusTreePage *node, const KeyType *key, bool inclusive) const -> int {
+  if (node->IsLeafPage()) {
+    auto *leaf = reinterpret_cast<LeafPage *>(node);
+    if (leaf->IsDeleted()) {
+      return -1;
+    }
+    if (key == nullptr) {
+      return !inclusive && leaf->GetNextPageId() != INVALID_PAGE_ID ? 1 : 0;
+    }
+    return leaf->CompareFences(*key, comparator_, inclusive);
+  }
+  auto *internal = reinterpret_cast<InternalPage *>(node);
+  if (internal->IsDeleted()) {
+    return -1;
+  }
+  if (key == nullptr) {
+    return !inclusive && internal->GetNextPageId() != INVALID_PAGE_ID ? 1 : 0;
+  }
+  return internal->CompareFences(*key, comparator_, inclusive);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::RightLink(BPlusTreePage *node) const -> page_id_t {
+  return node->IsLeafPage() ? reinterpret_cast<LeafPage *>(node)->GetNextPageId()
+                            : reinterpret_cast<InternalPage *>(node)->GetNextPageId();
+}
+
+/*
+ * Fetch and latch the root page, or return nullptr if the tree is empty. The
+ * root latch is only held until the root page is latched.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FetchRootForRead(bool write_leaf) -> Page * {
+  root_latch_.RLock();
+  if (root_page_id_ == INVALID_PAGE_ID) {
+    root_latch_.RUnlock();
+    return nullptr;
+  }
+  Page *page = FetchForRead(root_page_id_, write_leaf);
+  root_latch_.RUnlock();
+  return page;
+}
+
+/*
+ * A page is checked for being a leaf before it is latched, which is safe
+ * because the type of a page never changes after it was linked into the tree.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FetchForRead(page_id_t page_id, bool write_leaf) -> Page * {
+  Page *page = FetchPage(page_id);
+  if (write_leaf && reinterpret_cast<BPlusTreePage *>(page->GetData())->IsLeafPage()) {
+    page->WLatch();
+  } else {
+    page->RLatch();
+  }
+  return page;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::ReleaseForRead(Page *page, bool write_leaf) {
+  if (write_leaf && reinterpret_cast<BPlusTreePage *>(page->GetData())->IsLeafPage()) {
+    page->WUnlatch();
+  } else {
+    page->RUnlatch();
+  }
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+}
+
+/*
+ * Find the leaf page for a write, latching every page on the way in write
+ * mode. All latches above a page are released once the page is safe for the
+ * operation, the remaining ones are kept in the transaction's page set, and a
+ * nullptr in the page set stands for the root latch.
+ * @return : the write latched leaf page, or nullptr if the tree is empty, in
+ * which case the root latch is still held
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FindLeafPageForWrite(const KeyType &key, Operation op, Transaction *transaction, bool left_most)
+    -> Page * {
+  root_latch_.WLock();
+  transaction->AddIntoPageSet(nullptr);
+  if (root_page_id_ == INVALID_PAGE_ID) {
+    return nullptr;
+  }
+  Page *page = FetchPage(root_page_id_);
+  page->WLatch();
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  if (IsSafe(node, op)) {
+    ReleaseLatchedPages(transaction, false);
+  }
+  transaction->AddIntoPageSet(page);
+
+  while (!node->IsLeafPage()) {
+    auto *internal = reinterpret_cast<InternalPage *>(node);
+    page = FetchPage(left_most ? internal->ValueAt(0) : internal->Lookup(key, comparator_));
+    page->WLatch();
+    node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    if (IsSafe(node, op)) {
+      ReleaseLatchedPages(transaction, false);
+    }
+    transaction->AddIntoPageSet(page);
+  }
+  return page;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::IsSafe(BPlusTreePage *node, Operation op) const -> bool {
+  if (op == Operation::INSERT) {
+    // a leaf splits as soon as it is full, an internal page when it overflows
+    return node->IsLeafPage() ? node->GetSize() + 1 < node->GetMaxSize() : node->GetSize() < node->GetMaxSize();
+  }
+  if (node->IsRootPage()) {
+    // the root goes away when it is an empty leaf or an internal page with a single child, compaction never
+    // changes a root leaf
+    if (node->IsLeafPage()) {
+      return op == Operation::COMPACT || node->GetSize() > 1;
+    }
+    return node->GetSize() > 2;
+  }
+  if (!node->IsLeafPage()) {
+    return node->GetSize() > node->GetMinSize();
+  }
+  // removes let a leaf underflow down to the merge size, compaction only rebalances a leaf below the min size
+  return op == Operation::COMPACT ? node->GetSize() >= node->GetMinSize() : node->GetSize() > leaf_merge_size_;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::ReleaseLatchedPages(Transaction *transaction, bool is_dirty) {
+  auto page_set = transaction->GetPageSet();
+  while (!page_set->empty()) {
+    Page *page = page_set->front();
+    page_set->pop_front();
+    if (page == nullptr) {
+      root_latch_.WUnlock();
+      continue;
+    }
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), is_dirty);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::DeletePages(Transaction *transaction) {
+  auto deleted_page_set = transaction->GetDeletedPageSet();
+  for (page_id_t page_id : *deleted_page_set) {
+    buffer_pool_manager_->DeletePage(page_id);
+  }
+  deleted_page_set->clear();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FetchPage(page_id_t page_id) -> Page * {
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch a page of the b+ tree");
+  }
+  return page;
+}
+
+/*
+ * Update/Insert root page id in header page(page_id = 0 unless the tree was
+ * given another one, header_page is defined under include/page/header_page.h)
  * Call this method everytime root page id is changed.
  * @parameter: insert_record      defualt value is false. When set to true,
  * insert a record <index_name, root_page_id> into header page instead of
- * updating it.
+ * updating it. The record is kept when the tree becomes empty, so it is
+ * updated instead if it already exists.
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::UpdateRootPageId(int insert_record) {
-  auto *header_page = static_cast<HeaderPage *>(buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
+  auto *header_page = static_cast<HeaderPage *>(FetchPage(header_page_id_));
   if (insert_record != 0) {
     // create a new record<index_name + root_page_id> in header_page
-    header_page->InsertRecord(index_name_, root_page_id_);
+    if (!header_page->InsertRecord(index_name_, root_page_id_)) {
+      header_page->UpdateRecord(index_name_, root_page_id_);
+    }
   } else {
     // update root_page_id in header_page
     header_page->UpdateRecord(index_name_, root_page_id_);
   }
-  buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
+  buffer_pool_manager_->UnpinPage(header_page_id_, true);
 }
 
 /*
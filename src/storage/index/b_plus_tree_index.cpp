@@ -9,58 +9,171 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <cstring>
+#include <limits>
+
+#include "common/exception.h"
 #include "storage/index/b_plus_tree_index.h"
 
 namespace bustub {
+/*
+ * The number of leading bytes a key tuple of the key schema can occupy. Tuples do not hold varchar
+ * values to their declared length, so a key with a varchar takes every byte the RID leaves, and a
+ * longer key is cut off there.
+ */
+static auto KeyWidth(const Schema *key_schema, size_t key_size) -> size_t {
+  // without the RID, entries of equal keys would replace each other
+  if (key_schema->GetLength() + sizeof(RID) > key_size) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "the index key type has no room for the key columns and the RID");
+  }
+  if (!key_schema->GetUnlinedColumns().empty()) {
+    return key_size - sizeof(RID);
+  }
+  return key_schema->GetLength();
+}
+
 /*
  * Constructor
  */
 INDEX_TEMPLATE_ARGUMENTS
-BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager)
+BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager,
+                                     page_id_t header_page_id)
     : Index(std::move(metadata)),
-      comparator_(GetMetadata()->GetKeySchema()),
-      container_(GetMetadata()->GetName(), buffer_pool_manager, comparator_) {}
+      key_width_(static_cast<int>(KeyWidth(GetMetadata()->GetKeySchema(), sizeof(KeyType)))),
+      comparator_(GetMetadata()->GetKeySchema(), key_width_),
+      container_(GetMetadata()->GetName(), buffer_pool_manager, comparator_,
+                 BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>::Capacity(key_width_ + sizeof(RID)),
+                 BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>::Capacity(key_width_ + sizeof(RID)),
+                 key_width_ + sizeof(RID), 0.25, header_page_id) {}
 
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
-  // construct insert index key
+auto BPLUSTREE_INDEX_TYPE::MakeKey(const Tuple &key, RID rid) const -> KeyType {
   KeyType index_key;
   index_key.SetFromKey(key);
+  SetRid(&index_key, rid);
+  return index_key;
+}
 
-  container_.Insert(index_key, rid, transaction);
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::SetRid(KeyType *key, RID rid) const {
+  memcpy(reinterpret_cast<char *>(key) + key_width_, &rid, sizeof(RID));
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
-  // construct delete index key
-  KeyType index_key;
-  index_key.SetFromKey(key);
+void BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  container_.Insert(MakeKey(key, rid), rid, transaction);
+}
 
-  container_.Remove(index_key, transaction);
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  container_.Remove(MakeKey(key, rid), transaction);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
-  // construct scan index key
-  KeyType index_key;
-  index_key.SetFromKey(key);
+  // all entries of the key lie between the smallest and the largest rid
+  KeyType lower = MakeKey(key, RID(std::numeric_limits<page_id_t>::min(), 0));
+  KeyType upper = MakeKey(key, RID(std::numeric_limits<page_id_t>::max(), std::numeric_limits<uint32_t>::max()));
+  for (auto iterator = container_.Begin(lower, upper); !iterator.IsEnd(); ++iterator) {
+    result->push_back((*iterator).second);
+  }
+}
 
-  container_.GetValue(index_key, result, transaction);
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::Scan(const Tuple *lower, const Tuple *upper, Transaction *transaction)
+    -> std::unique_ptr<IndexCursor> {
+  std::optional<KeyType> upper_key;
+  if (upper != nullptr) {
+    upper_key = MakeKey(*upper, RID(std::numeric_limits<page_id_t>::max(), std::numeric_limits<uint32_t>::max()));
+  }
+  INDEXITERATOR_TYPE iterator;
+  if (lower != nullptr) {
+    KeyType lower_key = MakeKey(*lower, RID(std::numeric_limits<page_id_t>::min(), 0));
+    iterator = upper_key.has_value() ? container_.Begin(lower_key, *upper_key) : container_.Begin(lower_key);
+  } else {
+    iterator = INDEXITERATOR_TYPE(&container_, container_.FindLeafPage(KeyType(), true), 0, upper_key);
+  }
+  return std::make_unique<BPlusTreeIndexCursor<KeyType, ValueType, KeyComparator>>(std::move(iterator),
+                                                                                    GetKeySchema());
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::BulkLoad(const std::vector<std::pair<KeyType, ValueType>> &entries,
+                                    Transaction *transaction) {
+  std::vector<std::pair<KeyType, ValueType>> suffixed(entries);
+  for (auto &[key, rid] : suffixed) {
+    SetRid(&key, rid);
+  }
+  container_.BulkLoad(suffixed, transaction);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_INDEX_TYPE::GetBeginIterator() -> INDEXITERATOR_TYPE { return container_.Begin(); }
 
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_INDEX_TYPE::GetBeginIterator(const KeyType &key) -> INDEXITERATOR_TYPE { return container_.Begin(key); }
+auto BPLUSTREE_INDEX_TYPE::GetBeginIterator(const KeyType &key) -> INDEXITERATOR_TYPE {
+  KeyType lower = key;
+  SetRid(&lower, RID(std::numeric_limits<page_id_t>::min(), 0));
+  return container_.Begin(lower);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::GetBeginIterator(const KeyType &lower, const KeyType &upper) -> INDEXITERATOR_TYPE {
+  KeyType lower_key = lower;
+  KeyType upper_key = upper;
+  SetRid(&lower_key, RID(std::numeric_limits<page_id_t>::min(), 0));
+  SetRid(&upper_key, RID(std::numeric_limits<page_id_t>::max(), std::numeric_limits<uint32_t>::max()));
+  return container_.Begin(lower_key, upper_key);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::GetReverseBeginIterator() -> INDEXITERATOR_TYPE { return container_.RBegin(); }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::GetReverseBeginIterator(const KeyType &lower, const KeyType &upper) -> INDEXITERATOR_TYPE {
+  KeyType lower_key = lower;
+  KeyType upper_key = upper;
+  SetRid(&lower_key, RID(std::numeric_limits<page_id_t>::min(), 0));
+  SetRid(&upper_key, RID(std::numeric_limits<page_id_t>::max(), std::numeric_limits<uint32_t>::max()));
+  return container_.RBegin(lower_key, upper_key);
+}
 
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_INDEX_TYPE::GetEndIterator() -> INDEXITERATOR_TYPE { return container_.End(); }
 
+INDEX_TEMPLATE_ARGUMENTS
+BPlusTreeIndexCursor<KeyType, ValueType, KeyComparator>::BPlusTreeIndexCursor(INDEXITERATOR_TYPE &&iterator,
+                                                                              Schema *key_schema)
+    : iterator_(std::move(iterator)), key_schema_(key_schema) {}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPlusTreeIndexCursor<KeyType, ValueType, KeyComparator>::Next(RID *rid, std::vector<Value> *key_values) -> bool {
+  if (iterator_.IsEnd()) {
+    return false;
+  }
+  const auto &[key, value] = *iterator_;
+  *rid = value;
+  if (key_values != nullptr) {
+    // the rid a key may carry lies behind the key columns
+    key_values->clear();
+    for (uint32_t i = 0; i < key_schema_->GetColumnCount(); i++) {
+      key_values->push_back(key.ToValue(key_schema_, i));
+    }
+  }
+  ++iterator_;
+  return true;
+}
+
 template class BPlusTreeIndex<GenericKey<4>, RID, GenericComparator<4>>;
 template class BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTreeIndex<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTreeIndex<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTreeIndex<GenericKey<64>, RID, GenericComparator<64>>;
 
+template class BPlusTreeIndexCursor<GenericKey<4>, RID, GenericComparator<4>>;
+template class BPlusTreeIndexCursor<GenericKey<8>, RID, GenericComparator<8>>;
+template class BPlusTreeIndexCursor<GenericKey<16>, RID, GenericComparator<16>>;
+template class BPlusTreeIndexCursor<GenericKey<32>, RID, GenericComparator<32>>;
+template class BPlusTreeIndexCursor<GenericKey<64>, RID, GenericComparator<64>>;
+
 }  // namespace bustub
@@ -3,6 +3,15 @@
 #include "storage/index/extendible_hash_table_index.h"
 
 namespace bustub {
+/*
+ * Specializes the hash function for the index's key schema
+ */
+template <typename KeyType>
+static auto BindKeySchema(HashFunction<KeyType> hash_fn, const Schema *key_schema) -> HashFunction<KeyType> {
+  hash_fn.BindKeySchema(key_schema);
+  return hash_fn;
+}
+
 /*
  * Constructor
  */
@@ -12,7 +21,8 @@ HASH_TABLE_INDEX_TYPE::ExtendibleHashTableIndex(std::unique_ptr<IndexMetadata> &
                                                 const HashFunction<KeyType> &hash_fn)
     : Index(std::move(metadata)),
       comparator_(GetMetadata()->GetKeySchema()),
-      container_(GetMetadata()->GetName(), buffer_pool_manager, comparator_, hash_fn) {}
+      container_(GetMetadata()->GetName(), buffer_pool_manager, comparator_,
+                 BindKeySchema(hash_fn, GetMetadata()->GetKeySchema())) {}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
@@ -40,6 +50,12 @@ void HASH_TABLE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result,
 
   container_.GetValue(transaction, index_key, result);
 }
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_INDEX_TYPE::BulkLoad(const std::vector<std::pair<KeyType, ValueType>> &entries,
+                                     Transaction *transaction) {
+  container_.BulkLoad(transaction, entries);
+}
 template class ExtendibleHashTableIndex<GenericKey<4>, RID, GenericComparator<4>>;
 template class ExtendibleHashTableIndex<GenericKey<8>, RID, GenericComparator<8>>;
 template class ExtendibleHashTableIndex<GenericKey<16>, RID, GenericComparator<16>>;
@@ -2,29 +2,169 @@
  * index_iterator.cpp
  */
 #include <cassert>
+#include <utility>
 
+#include "common/exception.h"
+#include "storage/index/b_plus_tree.h"
 #include "storage/index/index_iterator.h"
 
 namespace bustub {
 
-/*
- * NOTE: you can change the destructor/constructor method here
- * set your own input parameters
- */
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::IndexIterator() = default;
 
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::~IndexIterator() = default;  // NOLINT
+INDEXITERATOR_TYPE::IndexIterator(Tree *tree, Page *page, int index, std::optional<KeyType> upper)
+    : tree_(tree), bound_(std::move(upper)) {
+  if (page != nullptr) {
+    LoadLeaf(page, index);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE::IndexIterator(Tree *tree, std::optional<KeyType> upper, std::optional<KeyType> lower)
+    : tree_(tree), reverse_(true), bound_(std::move(lower)) {
+  LoadLeafBefore(upper.has_value() ? &upper.value() : nullptr, true);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::IsEnd() -> bool { return page_id_ == INVALID_PAGE_ID; }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::operator*() -> const MappingType & {
+  assert(!IsEnd());
+  return items_[reverse_ ? offset_ - index_ : index_ - offset_];
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::operator++() -> INDEXITERATOR_TYPE & {
+  assert(!IsEnd());
+  index_ += reverse_ ? -1 : 1;
+  if ((reverse_ ? offset_ - index_ : index_ - offset_) == static_cast<int>(items_.size())) {
+    NextLeaf();
+  }
+  return *this;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::LoadLeaf(Page *page, int index) {
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  page_id_ = page->GetPageId();
+  next_page_id_ = leaf->GetNextPageId();
+  fence_ = leaf->GetHighKey();
+  index_ = index;
+  offset_ = index;
+  items_.clear();
+  for (int i = index; i < leaf->GetSize(); i++) {
+    items_.push_back(leaf->GetItem(i));
+  }
+  // the keys of the next leaf are greater than the last key of this one
+  if (bound_.has_value() && leaf->GetSize() > 0 &&
+      tree_->comparator_(leaf->KeyAt(leaf->GetSize() - 1), bound_.value()) >= 0) {
+    next_page_id_ = INVALID_PAGE_ID;
+    while (!items_.empty() && tree_->comparator_(items_.back().first, bound_.value()) > 0) {
+      items_.pop_back();
+    }
+  }
+  page->RUnlatch();
+  tree_->buffer_pool_manager_->UnpinPage(page_id_, false);
+  if (items_.empty()) {
+    NextLeaf();
+  }
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-auto INDEXITERATOR_TYPE::IsEnd() -> bool { throw std::runtime_error("unimplemented"); }
+void INDEXITERATOR_TYPE::LoadLeafBefore(const KeyType *key, bool inclusive) {
+  KeyType fence;
+  while (true) {
+    Page *page = tree_->FindLeafPageBefore(key, inclusive, &fence_);
+    if (page == nullptr) {
+      SetEnd();
+      return;
+    }
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    int index = leaf->GetSize() - 1;
+    if (key != nullptr) {
+      index = leaf->KeyIndex(*key, tree_->comparator_);
+      if (!inclusive || index == leaf->GetSize() || tree_->comparator_(leaf->KeyAt(index), *key) != 0) {
+        index--;
+      }
+    }
+    page_id_ = page->GetPageId();
+    index_ = index;
+    offset_ = index;
+    items_.clear();
+    for (int i = index; i >= 0; i--) {
+      items_.push_back(leaf->GetItem(i));
+    }
+    // the keys left of the leaf are less than its lower fence
+    if (fence_.has_value() && bound_.has_value() && tree_->comparator_(fence_.value(), bound_.value()) <= 0) {
+      fence_.reset();
+    }
+    if (!fence_.has_value() && bound_.has_value()) {
+      while (!items_.empty() && tree_->comparator_(items_.back().first, bound_.value()) < 0) {
+        items_.pop_back();
+      }
+    }
+    page->RUnlatch();
+    tree_->buffer_pool_manager_->UnpinPage(page_id_, false);
+    if (!items_.empty()) {
+      return;
+    }
+    if (!fence_.has_value()) {
+      SetEnd();
+      return;
+    }
+    fence = fence_.value();
+    key = &fence;
+    inclusive = false;
+  }
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-auto INDEXITERATOR_TYPE::operator*() -> const MappingType & { throw std::runtime_error("unimplemented"); }
+void INDEXITERATOR_TYPE::NextLeaf() {
+  if (reverse_) {
+    if (!fence_.has_value()) {
+      SetEnd();
+      return;
+    }
+    KeyType fence = fence_.value();
+    LoadLeafBefore(&fence, false);
+    return;
+  }
+  if (next_page_id_ == INVALID_PAGE_ID) {
+    SetEnd();
+    return;
+  }
+  // the next leaf continues at the high key of the last one, unless it was merged away or lost keys to the left
+  KeyType fence = fence_.value();
+  // a leaf deleted meanwhile was flushed with its deleted flag, and its page id is not handed out again
+  Page *page = tree_->buffer_pool_manager_->FetchPage(next_page_id_);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch the next leaf page");
+  }
+  page->RLatch();
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  if (leaf->IsDeleted() || leaf->CompareFences(fence, tree_->comparator_) != 0) {
+    page->RUnlatch();
+    tree_->buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = tree_->FindLeafPageRead(fence, false, false);
+    if (page == nullptr) {
+      SetEnd();
+      return;
+    }
+    leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  }
+  // keys the last leaf passed on to this one were already returned
+  LoadLeaf(page, leaf->KeyIndex(fence, tree_->comparator_));
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-auto INDEXITERATOR_TYPE::operator++() -> INDEXITERATOR_TYPE & { throw std::runtime_error("unimplemented"); }
+void INDEXITERATOR_TYPE::SetEnd() {
+  page_id_ = INVALID_PAGE_ID;
+  index_ = 0;
+  items_.clear();
+}
 
 template class IndexIterator<GenericKey<4>, RID, GenericComparator<4>>;
 
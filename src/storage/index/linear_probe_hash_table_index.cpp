@@ -3,6 +3,15 @@
 #include "storage/index/linear_probe_hash_table_index.h"
 
 namespace bustub {
+/*
+ * Specializes the hash function for the index's key schema
+ */
+template <typename KeyType>
+static auto BindKeySchema(HashFunction<KeyType> hash_fn, const Schema *key_schema) -> HashFunction<KeyType> {
+  hash_fn.BindKeySchema(key_schema);
+  return hash_fn;
+}
+
 /*
  * Constructor
  */
@@ -12,7 +21,8 @@ HASH_TABLE_INDEX_TYPE::LinearProbeHashTableIndex(std::unique_ptr<IndexMetadata>
                                                  const HashFunction<KeyType> &hash_fn)
     : Index(std::move(metadata)),
       comparator_(GetMetadata()->GetKeySchema()),
-      container_(GetMetadata()->GetName(), buffer_pool_manager, comparator_, num_buckets, hash_fn) {}
+      container_(GetMetadata()->GetName(), buffer_pool_manager, comparator_, num_buckets,
+                 BindKeySchema(hash_fn, GetMetadata()->GetKeySchema())) {}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
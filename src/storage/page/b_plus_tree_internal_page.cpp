@@ -9,6 +9,8 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <sstream>
 
@@ -21,38 +23,168 @@ namespace bustub {
  *****************************************************************************/
 /*
  * Init method after creating a new internal page
- * Including set page type, set current size, set page id, set parent id and set
- * max page size
+ * Including set page type, set current size, set page id, set parent id, set
+ * next page id, set max page size and set the number of key bytes stored per entry
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size, int key_width) {
+  SetPageType(IndexPageType::INTERNAL_PAGE);
+  SetSize(0);
+  SetPageId(page_id);
+  SetParentPageId(parent_id);
+  SetNextPageId(INVALID_PAGE_ID);
+  SetMaxSize(max_size);
+  key_width_ = key_width;
+  flags_ = 0;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::Capacity(int key_width) -> int {
+  return static_cast<int>((PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE - 2 * key_width) / (key_width + sizeof(ValueType)));
+}
+
+/*
+ * Helper methods to get/set the right link and the fence keys, see the leaf page
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetNextPageId() const -> page_id_t { return next_page_id_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::FenceAt(int index) -> char * { return data_ + index * key_width_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::FenceAt(int index) const -> const char * { return data_ + index * key_width_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetLowKey() const -> std::optional<KeyType> {
+  if ((flags_ & HAS_LOW_KEY) == 0) {
+    return std::nullopt;
+  }
+  KeyType key;
+  std::memset(&key, 0, sizeof(KeyType));
+  std::memcpy(&key, FenceAt(0), key_width_);
+  return key;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetLowKey(const std::optional<KeyType> &key) {
+  flags_ = key.has_value() ? flags_ | HAS_LOW_KEY : flags_ & ~HAS_LOW_KEY;
+  if (key.has_value()) {
+    std::memcpy(FenceAt(0), &key.value(), key_width_);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetHighKey() const -> std::optional<KeyType> {
+  if ((flags_ & HAS_HIGH_KEY) == 0) {
+    return std::nullopt;
+  }
+  KeyType key;
+  std::memset(&key, 0, sizeof(KeyType));
+  std::memcpy(&key, FenceAt(1), key_width_);
+  return key;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetHighKey(const std::optional<KeyType> &key) {
+  flags_ = key.has_value() ? flags_ | HAS_HIGH_KEY : flags_ & ~HAS_HIGH_KEY;
+  if (key.has_value()) {
+    std::memcpy(FenceAt(1), &key.value(), key_width_);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::CompareFences(const KeyType &key, const KeyComparator &comparator,
+                                                   bool inclusive) const -> int {
+  int limit = inclusive ? 0 : 1;
+  if ((flags_ & HAS_LOW_KEY) != 0 && comparator(key, *reinterpret_cast<const KeyType *>(FenceAt(0))) < limit) {
+    return -1;
+  }
+  if ((flags_ & HAS_HIGH_KEY) != 0 && comparator(key, *reinterpret_cast<const KeyType *>(FenceAt(1))) >= limit) {
+    return 1;
+  }
+  return 0;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::IsDeleted() const -> bool { return (flags_ & DELETED) != 0; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetDeleted() { flags_ |= DELETED; }
+
+/*
+ * Helper methods to locate an entry, which is the first key_width_ bytes of its
+ * key followed by the child page id, after the two fence keys
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::EntrySize() const -> size_t { return key_width_ + sizeof(ValueType); }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::EntryAt(int index) -> char * { return FenceAt(2) + index * EntrySize(); }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::EntryAt(int index) const -> const char * {
+  return FenceAt(2) + index * EntrySize();
+}
+
 /*
  * Helper method to get/set the key associated with input "index"(a.k.a
  * array offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::KeyAt(int index) const -> KeyType {
-  // replace with your own code
-  KeyType key{};
+  KeyType key;
+  std::memset(&key, 0, sizeof(KeyType));
+  std::memcpy(&key, EntryAt(index), key_width_);
   return key;
 }
 
+/*
+ * Helper method to compare against a stored key without copying it, see the
+ * leaf page
+ */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {}
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::KeyRefAt(int index) const -> const KeyType & {
+  return *reinterpret_cast<const KeyType *>(EntryAt(index));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {
+  std::memcpy(EntryAt(index), &key, key_width_);
+}
 
 /*
  * Helper method to find and return array index(or offset), so that its value
  * equals to input "value"
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const -> int { return 0; }
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const -> int {
+  for (int i = 0; i < GetSize(); i++) {
+    if (ValueAt(i) == value) {
+      return i;
+    }
+  }
+  return -1;
+}
 
 /*
  * Helper method to get the value associated with input "index"(a.k.a array
  * offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const -> ValueType { return 0; }
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const -> ValueType {
+  ValueType value;
+  std::memcpy(&value, EntryAt(index) + key_width_, sizeof(ValueType));
+  return value;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetValueAt(int index, const ValueType &value) {
+  std::memcpy(EntryAt(index) + key_width_, &value, sizeof(ValueType));
+}
 
 /*****************************************************************************
  * LOOKUP
@@ -64,7 +196,32 @@ auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const -> ValueType { ret
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyComparator &comparator) const -> ValueType {
-  return INVALID_PAGE_ID;
+  return ValueAt(LookupIndex(key, comparator));
+}
+
+/*
+ * Find the index of the last key that is not greater than the input key, or
+ * that is less than it if inclusive is not set. Index 0 stands for the child
+ * in front of all keys.
+ * Like the search in leaf pages, the range is halved without branching on the
+ * comparison.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::LookupIndex(const KeyType &key, const KeyComparator &comparator,
+                                                 bool inclusive) const -> int {
+  // a key is in front of the input key if the comparison is below this limit
+  int limit = inclusive ? 1 : 0;
+  int size = GetSize() - 1;
+  if (size <= 0) {
+    return 0;
+  }
+  int base = 1;
+  while (size > 1) {
+    int half = size / 2;
+    base = comparator(KeyRefAt(base + half), key) < limit ? base + half : base;
+    size -= half;
+  }
+  return base - (comparator(KeyRefAt(base), key) < limit ? 0 : 1);
 }
 
 /*****************************************************************************
@@ -78,7 +235,12 @@ auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyCompara
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::PopulateNewRoot(const ValueType &old_value, const KeyType &new_key,
-                                                     const ValueType &new_value) {}
+                                                     const ValueType &new_value) {
+  SetValueAt(0, old_value);
+  SetKeyAt(1, new_key);
+  SetValueAt(1, new_value);
+  SetSize(2);
+}
 /*
  * Insert new_key & new_value pair right after the pair with its value ==
  * old_value
@@ -87,7 +249,12 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::PopulateNewRoot(const ValueType &old_value,
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertNodeAfter(const ValueType &old_value, const KeyType &new_key,
                                                      const ValueType &new_value) -> int {
-  return 0;
+  int index = ValueIndex(old_value) + 1;
+  std::memmove(EntryAt(index + 1), EntryAt(index), (GetSize() - index) * EntrySize());
+  SetKeyAt(index, new_key);
+  SetValueAt(index, new_value);
+  IncreaseSize(1);
+  return GetSize();
 }
 
 /*****************************************************************************
@@ -98,14 +265,37 @@ auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertNodeAfter(const ValueType &old_value,
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveHalfTo(BPlusTreeInternalPage *recipient,
-                                                BufferPoolManager *buffer_pool_manager) {}
+                                                BufferPoolManager *buffer_pool_manager) {
+  // the first key of the recipient is the separator that moves up into the parent
+  int keep = (GetSize() + 1) / 2;
+  recipient->CopyNFrom(EntryAt(keep), GetSize() - keep, buffer_pool_manager);
+  SetSize(keep);
+}
 
-/* Copy entries into me, starting from {items} and copy {size} entries.
+/* Copy entries into me, starting from {entries} and copy {size} entries of a page of the same tree.
  * Since it is an internal page, for all entries (pages) moved, their parents page now changes to me.
  * So I need to 'adopt' them by changing their parent page id, which needs to be persisted with BufferPoolManger
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyNFrom(MappingType *items, int size, BufferPoolManager *buffer_pool_manager) {}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyNFrom(const char *entries, int size, BufferPoolManager *buffer_pool_manager) {
+  int first = GetSize();
+  std::memcpy(EntryAt(first), entries, size * EntrySize());
+  IncreaseSize(size);
+  for (int i = first; i < GetSize(); i++) {
+    Adopt(ValueAt(i), buffer_pool_manager);
+  }
+}
+
+/*
+ * Append children in order, adopting them. Used to build a page bottom up.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::AppendChildren(MappingType *items, int size,
+                                                    BufferPoolManager *buffer_pool_manager) {
+  for (int i = 0; i < size; i++) {
+    CopyLastFrom(items[i], buffer_pool_manager);
+  }
+}
 
 /*****************************************************************************
  * REMOVE
@@ -116,14 +306,20 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyNFrom(MappingType *items, int size, Buf
  * NOTE: store key&value pair continuously after deletion
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(int index) {}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(int index) {
+  std::memmove(EntryAt(index), EntryAt(index + 1), (GetSize() - index - 1) * EntrySize());
+  IncreaseSize(-1);
+}
 
 /*
  * Remove the only key & value pair in internal page and return the value
  * NOTE: only call this method within AdjustRoot()(in b_plus_tree.cpp)
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() -> ValueType { return INVALID_PAGE_ID; }
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() -> ValueType {
+  SetSize(0);
+  return ValueAt(0);
+}
 /*****************************************************************************
  * MERGE
  *****************************************************************************/
@@ -136,7 +332,11 @@ auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() -> ValueType { r
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
-                                               BufferPoolManager *buffer_pool_manager) {}
+                                               BufferPoolManager *buffer_pool_manager) {
+  SetKeyAt(0, middle_key);
+  recipient->CopyNFrom(EntryAt(0), GetSize(), buffer_pool_manager);
+  SetSize(0);
+}
 
 /*****************************************************************************
  * REDISTRIBUTE
@@ -151,14 +351,23 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeInternalPage *recipient,
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
-                                                      BufferPoolManager *buffer_pool_manager) {}
+                                                      BufferPoolManager *buffer_pool_manager) {
+  // afterwards the first key of this page is the new separator for the parent
+  recipient->CopyLastFrom(MappingType(middle_key, ValueAt(0)), buffer_pool_manager);
+  Remove(0);
+}
 
 /* Append an entry at the end.
  * Since it is an internal page, the moved entry(page)'s parent needs to be updated.
  * So I need to 'adopt' it by changing its parent page id, which needs to be persisted with BufferPoolManger
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyLastFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager) {}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyLastFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager) {
+  SetKeyAt(GetSize(), pair.first);
+  SetValueAt(GetSize(), pair.second);
+  IncreaseSize(1);
+  Adopt(pair.second, buffer_pool_manager);
+}
 
 /*
  * Remove the last key & value pair from this page to head of "recipient" page.
@@ -169,14 +378,40 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyLastFrom(const MappingType &pair, Buffe
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
-                                                       BufferPoolManager *buffer_pool_manager) {}
+                                                       BufferPoolManager *buffer_pool_manager) {
+  // afterwards the first key of the recipient is the new separator for the parent
+  recipient->SetKeyAt(0, middle_key);
+  recipient->CopyFirstFrom(MappingType(KeyAt(GetSize() - 1), ValueAt(GetSize() - 1)), buffer_pool_manager);
+  IncreaseSize(-1);
+}
 
 /* Append an entry at the beginning.
  * Since it is an internal page, the moved entry(page)'s parent needs to be updated.
  * So I need to 'adopt' it by changing its parent page id, which needs to be persisted with BufferPoolManger
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyFirstFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager) {}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyFirstFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager) {
+  std::memmove(EntryAt(1), EntryAt(0), GetSize() * EntrySize());
+  SetKeyAt(0, pair.first);
+  SetValueAt(0, pair.second);
+  IncreaseSize(1);
+  Adopt(pair.second, buffer_pool_manager);
+}
+
+/*
+ * Point the parent page id of a child that moved into this page at me.
+ * The child is not latched: every writer that reads a parent page id holds
+ * the latch of that parent, which is this page.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Adopt(const ValueType &child_page_id, BufferPoolManager *buffer_pool_manager) {
+  Page *page = buffer_pool_manager->FetchPage(child_page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch a child page to adopt it");
+  }
+  reinterpret_cast<BPlusTreePage *>(page->GetData())->SetParentPageId(GetPageId());
+  buffer_pool_manager->UnpinPage(child_page_id, true);
+}
 
 // valuetype for internalNode should be page id_t
 template class BPlusTreeInternalPage<GenericKey<4>, page_id_t, GenericComparator<4>>;
@@ -9,6 +9,8 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <cstring>
 #include <sstream>
 
 #include "common/exception.h"
@@ -24,27 +26,157 @@ namespace bustub {
 /**
  * Init method after creating a new leaf page
  * Including set page type, set current size to zero, set page id/parent id, set
- * next page id and set max size
+ * next page id, set max size and set the number of key bytes stored per entry
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size, int key_width) {
+  SetPageType(IndexPageType::LEAF_PAGE);
+  SetSize(0);
+  SetPageId(page_id);
+  SetParentPageId(parent_id);
+  SetNextPageId(INVALID_PAGE_ID);
+  SetMaxSize(max_size);
+  key_width_ = key_width;
+  flags_ = 0;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::Capacity(int key_width) -> int {
+  return static_cast<int>((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE - 2 * key_width) / (key_width + sizeof(ValueType)));
+}
 
 /**
  * Helper methods to set/get next page id
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetNextPageId() const -> page_id_t { return INVALID_PAGE_ID; }
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetNextPageId() const -> page_id_t { return next_page_id_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+/*
+ * Helper methods to get/set the fence keys, which are stored like the keys of
+ * the entries, in front of them
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::FenceAt(int index) -> char * { return data_ + index * key_width_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::FenceAt(int index) const -> const char * { return data_ + index * key_width_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetLowKey() const -> std::optional<KeyType> {
+  if ((flags_ & HAS_LOW_KEY) == 0) {
+    return std::nullopt;
+  }
+  KeyType key;
+  std::memset(&key, 0, sizeof(KeyType));
+  std::memcpy(&key, FenceAt(0), key_width_);
+  return key;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetLowKey(const std::optional<KeyType> &key) {
+  flags_ = key.has_value() ? flags_ | HAS_LOW_KEY : flags_ & ~HAS_LOW_KEY;
+  if (key.has_value()) {
+    std::memcpy(FenceAt(0), &key.value(), key_width_);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetHighKey() const -> std::optional<KeyType> {
+  if ((flags_ & HAS_HIGH_KEY) == 0) {
+    return std::nullopt;
+  }
+  KeyType key;
+  std::memset(&key, 0, sizeof(KeyType));
+  std::memcpy(&key, FenceAt(1), key_width_);
+  return key;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetHighKey(const std::optional<KeyType> &key) {
+  flags_ = key.has_value() ? flags_ | HAS_HIGH_KEY : flags_ & ~HAS_HIGH_KEY;
+  if (key.has_value()) {
+    std::memcpy(FenceAt(1), &key.value(), key_width_);
+  }
+}
+
+/*
+ * The keys of the page are not less than the low key and less than the high
+ * key. The keys right before a key lie in the page if the key is greater than
+ * the low key and not greater than the high key.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::CompareFences(const KeyType &key, const KeyComparator &comparator,
+                                               bool inclusive) const -> int {
+  int limit = inclusive ? 0 : 1;
+  if ((flags_ & HAS_LOW_KEY) != 0 && comparator(key, *reinterpret_cast<const KeyType *>(FenceAt(0))) < limit) {
+    return -1;
+  }
+  if ((flags_ & HAS_HIGH_KEY) != 0 && comparator(key, *reinterpret_cast<const KeyType *>(FenceAt(1))) >= limit) {
+    return 1;
+  }
+  return 0;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::IsDeleted() const -> bool { return (flags_ & DELETED) != 0; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetDeleted() { flags_ |= DELETED; }
+
+/*
+ * Helper methods to locate an entry, which is the first key_width_ bytes of its
+ * key followed by its value. The value is not aligned, so it is copied in and out.
+ * The entries start after the two fence keys.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::EntrySize() const -> size_t { return key_width_ + sizeof(ValueType); }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::EntryAt(int index) -> char * { return FenceAt(2) + index * EntrySize(); }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::EntryAt(int index) const -> const char * { return FenceAt(2) + index * EntrySize(); }
+
+/*
+ * Helper method to compare against a stored key without copying it. The bytes
+ * past the key width belong to the value or the next entry, but a comparator
+ * only reads the bytes of the key schema, which all lie within the key width.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::KeyRefAt(int index) const -> const KeyType & {
+  return *reinterpret_cast<const KeyType *>(EntryAt(index));
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetItemAt(int index, const KeyType &key, const ValueType &value) {
+  char *entry = EntryAt(index);
+  std::memcpy(entry, &key, key_width_);
+  std::memcpy(entry + key_width_, &value, sizeof(ValueType));
+}
 
 /**
- * Helper method to find the first index i so that array[i].first >= key
- * NOTE: This method is only used when generating index iterator
+ * Helper method to find the first index i so that KeyAt(i) >= key
+ * NOTE: This method is used when generating index iterator, and as the
+ * binary search behind insert, lookup and remove
+ * The search halves the range without branching on the comparison, so the
+ * compiler can use a conditional move and there is no misprediction per level.
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator &comparator) const -> int {
-  return 0;
+  int size = GetSize();
+  if (size == 0) {
+    return 0;
+  }
+  int base = 0;
+  while (size > 1) {
+    int half = size / 2;
+    base = comparator(KeyRefAt(base + half), key) < 0 ? base + half : base;
+    size -= half;
+  }
+  return base + (comparator(KeyRefAt(base), key) < 0 ? 1 : 0);
 }
 
 /*
@@ -53,32 +185,49 @@ auto B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparato
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_LEAF_PAGE_TYPE::KeyAt(int index) const -> KeyType {
-  // replace with your own code
-  KeyType key{};
+  KeyType key;
+  std::memset(&key, 0, sizeof(KeyType));
+  std::memcpy(&key, EntryAt(index), key_width_);
   return key;
 }
 
+/*
+ * Helper method to find and return the value associated with input "index"(a.k.a
+ * array offset)
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::ValueAt(int index) const -> ValueType {
+  ValueType value;
+  std::memcpy(&value, EntryAt(index) + key_width_, sizeof(ValueType));
+  return value;
+}
+
 /*
  * Helper method to find and return the key & value pair associated with input
  * "index"(a.k.a array offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) -> const MappingType & {
-  // replace with your own code
-  return array_[0];
-}
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) const -> MappingType { return {KeyAt(index), ValueAt(index)}; }
 
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
 /*
  * Insert key & value pair into leaf page ordered by key
+ * If the key already exists, the page is left unchanged
  * @return  page size after insertion
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator)
     -> int {
-  return 0;
+  int index = KeyIndex(key, comparator);
+  if (index < GetSize() && comparator(KeyRefAt(index), key) == 0) {
+    return GetSize();
+  }
+  std::memmove(EntryAt(index + 1), EntryAt(index), (GetSize() - index) * EntrySize());
+  SetItemAt(index, key, value);
+  IncreaseSize(1);
+  return GetSize();
 }
 
 /*****************************************************************************
@@ -88,13 +237,32 @@ auto B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &val
  * Remove half of key & value pairs from this page to "recipient" page
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveHalfTo(BPlusTreeLeafPage *recipient) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveHalfTo(BPlusTreeLeafPage *recipient) {
+  int keep = GetSize() / 2;
+  recipient->CopyNFrom(EntryAt(keep), GetSize() - keep);
+  SetSize(keep);
+}
+
+/*
+ * Copy starting from entries, and copy {size} number of entries into me.
+ * The entries come from a page of the same tree, so they have the same width.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyNFrom(const char *entries, int size) {
+  std::memcpy(EntryAt(GetSize()), entries, size * EntrySize());
+  IncreaseSize(size);
+}
 
 /*
- * Copy starting from items, and copy {size} number of elements into me.
+ * Append sorted items at the end. Used to build a page bottom up.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyNFrom(MappingType *items, int size) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::AppendItems(const MappingType *items, int size) {
+  for (int i = 0; i < size; i++) {
+    SetItemAt(GetSize() + i, items[i].first, items[i].second);
+  }
+  IncreaseSize(size);
+}
 
 /*****************************************************************************
  * LOOKUP
@@ -107,7 +275,12 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyNFrom(MappingType *items, int size) {}
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType *value, const KeyComparator &comparator) const
     -> bool {
-  return false;
+  int index = KeyIndex(key, comparator);
+  if (index == GetSize() || comparator(KeyRefAt(index), key) != 0) {
+    return false;
+  }
+  *value = ValueAt(index);
+  return true;
 }
 
 /*****************************************************************************
@@ -121,7 +294,13 @@ auto B_PLUS_TREE_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType *value, co
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const KeyComparator &comparator) -> int {
-  return 0;
+  int index = KeyIndex(key, comparator);
+  if (index == GetSize() || comparator(KeyRefAt(index), key) != 0) {
+    return GetSize();
+  }
+  std::memmove(EntryAt(index), EntryAt(index + 1), (GetSize() - index - 1) * EntrySize());
+  IncreaseSize(-1);
+  return GetSize();
 }
 
 /*****************************************************************************
@@ -132,7 +311,11 @@ auto B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const
  * to update the next_page id in the sibling page
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient) {
+  recipient->CopyNFrom(EntryAt(0), GetSize());
+  recipient->SetNextPageId(GetNextPageId());
+  SetSize(0);
+}
 
 /*****************************************************************************
  * REDISTRIBUTE
@@ -141,25 +324,39 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient) {}
  * Remove the first key & value pair from this page to "recipient" page.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeLeafPage *recipient) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeLeafPage *recipient) {
+  recipient->CopyLastFrom(EntryAt(0));
+  std::memmove(EntryAt(0), EntryAt(1), (GetSize() - 1) * EntrySize());
+  IncreaseSize(-1);
+}
 
 /*
- * Copy the item into the end of my item list. (Append item to my array)
+ * Copy the entry into the end of my entry list. (Append entry to my array)
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyLastFrom(const MappingType &item) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyLastFrom(const char *entry) {
+  std::memcpy(EntryAt(GetSize()), entry, EntrySize());
+  IncreaseSize(1);
+}
 
 /*
  * Remove the last key & value pair from this page to "recipient" page.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeLeafPage *recipient) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeLeafPage *recipient) {
+  recipient->CopyFirstFrom(EntryAt(GetSize() - 1));
+  IncreaseSize(-1);
+}
 
 /*
- * Insert item at the front of my items. Move items accordingly.
+ * Insert entry at the front of my entries. Move entries accordingly.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyFirstFrom(const MappingType &item) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyFirstFrom(const char *entry) {
+  std::memmove(EntryAt(1), EntryAt(0), GetSize() * EntrySize());
+  std::memcpy(EntryAt(0), entry, EntrySize());
+  IncreaseSize(1);
+}
 
 template class BPlusTreeLeafPage<GenericKey<4>, RID, GenericComparator<4>>;
 template class BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
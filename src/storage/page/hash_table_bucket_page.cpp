@@ -11,6 +11,16 @@
 //===----------------------------------------------------------------------===//
 
 #include "storage/page/hash_table_bucket_page.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+
 #include "common/logger.h"
 #include "common/util/hash_util.h"
 #include "storage/index/generic_key.h"
@@ -19,14 +29,38 @@
 
 namespace bustub {
 
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_BUCKET_TYPE::Init() {
+  overflow_page_id_ = INVALID_PAGE_ID;
+  memset(occupied_, 0, sizeof(occupied_));
+  memset(readable_, 0, sizeof(readable_));
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_BUCKET_TYPE::GetOverflowPageId() const -> page_id_t {
+  return overflow_page_id_;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_BUCKET_TYPE::SetOverflowPageId(page_id_t overflow_page_id) {
+  overflow_page_id_ = overflow_page_id;
+}
+
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::GetValue(KeyType key, KeyComparator cmp, std::vector<ValueType> *result) -> bool {
-  for (size_t i = 0; i < BUCKET_ARRAY_SIZE; i++) {
-    if (!IsOccupied(i)) {
-      break;
+  uint8_t fingerprint = Fingerprint(key);
+  for (uint32_t base = 0; base < BUCKET_ARRAY_SIZE; base += PROBE_WIDTH) {
+    uint32_t match = MatchFingerprint(base, fingerprint) & LoadMask(readable_, base);
+    while (match != 0) {
+      uint32_t bucket_idx = base + __builtin_ctz(match);
+      match &= match - 1;
+      if (cmp(key, KeyAt(bucket_idx)) == 0) {
+        result->push_back(ValueAt(bucket_idx));
+      }
     }
-    if (IsReadable(i) && cmp(key, KeyAt(i)) == 0) {
-      result->push_back(ValueAt(i));
+    // occupied slots always form a prefix of the bucket
+    if (LoadMask(occupied_, base) != FULL_PROBE_MASK) {
+      break;
     }
   }
 
@@ -35,35 +69,52 @@ auto HASH_TABLE_BUCKET_TYPE::GetValue(KeyType key, KeyComparator cmp, std::vecto
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::Insert(KeyType key, ValueType value, KeyComparator cmp) -> bool {
-  for (size_t i = 0; i < BUCKET_ARRAY_SIZE; i++) {
-    if (!IsOccupied(i)) {
-      break;
+  uint8_t fingerprint = Fingerprint(key);
+  uint32_t free_idx = BUCKET_ARRAY_SIZE;
+  for (uint32_t base = 0; base < BUCKET_ARRAY_SIZE; base += PROBE_WIDTH) {
+    uint32_t readable = LoadMask(readable_, base);
+    uint32_t match = MatchFingerprint(base, fingerprint) & readable;
+    while (match != 0) {
+      uint32_t bucket_idx = base + __builtin_ctz(match);
+      match &= match - 1;
+      if (cmp(key, KeyAt(bucket_idx)) == 0 && ValueAt(bucket_idx) == value) {
+        return false;
+      }
     }
-    if (IsOccupied(i) && IsReadable(i) && cmp(key, KeyAt(i)) == 0 && ValueAt(i) == value) {
-      return false;
+    if (free_idx == BUCKET_ARRAY_SIZE && readable != FULL_PROBE_MASK) {
+      free_idx = base + __builtin_ctz(~readable);
     }
-  }
-  for (size_t i = 0; i < BUCKET_ARRAY_SIZE; i++) {
-    if (!(IsOccupied(i) && IsReadable(i))) {
-      SetReadable(i);
-      SetOccupied(i);
-      array_[i].first = key;
-      array_[i].second = value;
-      return true;
+    if (LoadMask(occupied_, base) != FULL_PROBE_MASK) {
+      break;
     }
   }
-  return false;
+  if (free_idx >= BUCKET_ARRAY_SIZE) {
+    return false;
+  }
+
+  fingerprints_[free_idx] = fingerprint;
+  key_array_[free_idx] = key;
+  value_array_[free_idx] = value;
+  SetOccupied(free_idx);
+  SetReadable(free_idx);
+  return true;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::Remove(KeyType key, ValueType value, KeyComparator cmp) -> bool {
-  for (size_t i = 0; i < BUCKET_ARRAY_SIZE; i++) {
-    if (!IsOccupied(i)) {
-      break;
+  uint8_t fingerprint = Fingerprint(key);
+  for (uint32_t base = 0; base < BUCKET_ARRAY_SIZE; base += PROBE_WIDTH) {
+    uint32_t match = MatchFingerprint(base, fingerprint) & LoadMask(readable_, base);
+    while (match != 0) {
+      uint32_t bucket_idx = base + __builtin_ctz(match);
+      match &= match - 1;
+      if (cmp(key, KeyAt(bucket_idx)) == 0 && ValueAt(bucket_idx) == value) {
+        RemoveAt(bucket_idx);
+        return true;
+      }
     }
-    if (IsOccupied(i) && IsReadable(i) && cmp(key, KeyAt(i)) == 0 && ValueAt(i) == value) {
-      RemoveAt(i);
-      return true;
+    if (LoadMask(occupied_, base) != FULL_PROBE_MASK) {
+      break;
     }
   }
   return false;
@@ -71,12 +122,12 @@ auto HASH_TABLE_BUCKET_TYPE::Remove(KeyType key, ValueType value, KeyComparator
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::KeyAt(uint32_t bucket_idx) const -> KeyType {
-  return array_[bucket_idx].first;
+  return key_array_[bucket_idx];
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::ValueAt(uint32_t bucket_idx) const -> ValueType {
-  return array_[bucket_idx].second;
+  return value_array_[bucket_idx];
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
@@ -106,40 +157,17 @@ void HASH_TABLE_BUCKET_TYPE::SetReadable(uint32_t bucket_idx) {
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::IsFull() -> bool {
-  for (size_t i = 0; i < BUCKET_ARRAY_SIZE; i++) {
-    if (!IsOccupied(i)) {
-      return false;
-    }
-    if (IsOccupied(i) && IsReadable(i)) {
-      continue;
-    }
-    return false;
-  }
-  return true;
+  return CountBits(readable_) == BUCKET_ARRAY_SIZE;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::NumReadable() -> uint32_t {
-  uint32_t res = 0;
-  for (size_t i = 0; i < BUCKET_ARRAY_SIZE; i++) {
-    if (!IsOccupied(i)) {
-      return res;
-    }
-    if (IsOccupied(i) && IsReadable(i)) {
-      res++;
-    }
-  }
-  return res;
+  return CountBits(readable_);
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::IsEmpty() -> bool {
-  for (size_t i = 0; i < BUCKET_ARRAY_SIZE; i++) {
-    if (IsOccupied(i) && IsReadable(i)) {
-      return false;
-    }
-  }
-  return true;
+  return CountBits(readable_) == 0;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
@@ -167,21 +195,86 @@ void HASH_TABLE_BUCKET_TYPE::PrintBucket() {
 template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_BUCKET_TYPE::SetBit(char *array, uint32_t index, bool value) {
   uint32_t pos = index / 8;
-  uint32_t bit_pos = index % 8;
-  uint8_t mask = ((0b10000000) >> (bit_pos));
-  if (((array[pos] & mask) != 0 && !value) || (((array[pos] & mask) == 0) && value)) {
-    array[pos] = static_cast<char>(array[pos] ^ mask);
+  auto mask = static_cast<char>(1 << (index % 8));
+  if (value) {
+    array[pos] = static_cast<char>(array[pos] | mask);
+  } else {
+    array[pos] = static_cast<char>(array[pos] & ~mask);
   }
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_BUCKET_TYPE::GetBit(const char *array, uint32_t index) const {
   uint32_t pos = index / 8;
-  uint32_t bit_pos = index % 8;
-  uint32_t mask = ((0b10000000) >> (bit_pos));
+  uint32_t mask = 1 << (index % 8);
   return (array[pos] & mask) != 0;
 }
 
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_BUCKET_TYPE::Fingerprint(const KeyType &key) -> uint8_t {
+  // multiplicative hashing over the raw key bytes, one 64-bit word at a time; the top byte is the best mixed
+  const auto *bytes = reinterpret_cast<const char *>(&key);
+  uint64_t hash = 0;
+  size_t offset = 0;
+  for (; offset + sizeof(uint64_t) <= sizeof(KeyType); offset += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, bytes + offset, sizeof(uint64_t));
+    hash = (hash ^ word) * FINGERPRINT_MULTIPLIER;
+  }
+  if (offset < sizeof(KeyType)) {
+    uint64_t word = 0;
+    memcpy(&word, bytes + offset, sizeof(KeyType) - offset);
+    hash = (hash ^ word) * FINGERPRINT_MULTIPLIER;
+  }
+  return static_cast<uint8_t>(hash >> 56);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_BUCKET_TYPE::MatchFingerprint(uint32_t base, uint8_t fingerprint) const -> uint32_t {
+#if defined(__AVX2__)
+  __m256i needle = _mm256_set1_epi8(static_cast<char>(fingerprint));
+  __m256i group = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(fingerprints_ + base));
+  return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(group, needle)));
+#elif defined(__SSE2__)
+  __m128i needle = _mm_set1_epi8(static_cast<char>(fingerprint));
+  __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i *>(fingerprints_ + base));
+  return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(group, needle)));
+#else
+  uint32_t mask = 0;
+  for (uint32_t i = 0; i < PROBE_WIDTH; i++) {
+    mask |= static_cast<uint32_t>(fingerprints_[base + i] == fingerprint) << i;
+  }
+  return mask;
+#endif
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_BUCKET_TYPE::LoadMask(const char *array, uint32_t base) const -> uint32_t {
+  uint32_t first = base / 8;
+  uint32_t last = std::min<uint32_t>(first + PROBE_WIDTH / 8, (BUCKET_ARRAY_SIZE - 1) / 8 + 1);
+  uint32_t mask = 0;
+  for (uint32_t pos = first; pos < last; pos++) {
+    mask |= static_cast<uint32_t>(static_cast<uint8_t>(array[pos])) << ((pos - first) * 8);
+  }
+  return mask;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_BUCKET_TYPE::CountBits(const char *array) const -> uint32_t {
+  constexpr size_t num_bytes = (BUCKET_ARRAY_SIZE - 1) / 8 + 1;
+  uint32_t count = 0;
+  size_t pos = 0;
+  for (; pos + sizeof(uint64_t) <= num_bytes; pos += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, array + pos, sizeof(uint64_t));
+    count += __builtin_popcountll(word);
+  }
+  for (; pos < num_bytes; pos++) {
+    count += __builtin_popcount(static_cast<uint8_t>(array[pos]));
+  }
+  return count;
+}
+
 // DO NOT REMOVE ANYTHING BELOW THIS LINE
 template class HashTableBucketPage<int, int, IntComparator>;
 
@@ -193,4 +286,11 @@ template class HashTableBucketPage<GenericKey<64>, RID, GenericComparator<64>>;
 
 // template class HashTableBucketPage<hash_t, TmpTuple, HashComparator>;
 
+static_assert(sizeof(HashTableBucketPage<int, int, IntComparator>) <= PAGE_SIZE);
+static_assert(sizeof(HashTableBucketPage<GenericKey<4>, RID, GenericComparator<4>>) <= PAGE_SIZE);
+static_assert(sizeof(HashTableBucketPage<GenericKey<8>, RID, GenericComparator<8>>) <= PAGE_SIZE);
+static_assert(sizeof(HashTableBucketPage<GenericKey<16>, RID, GenericComparator<16>>) <= PAGE_SIZE);
+static_assert(sizeof(HashTableBucketPage<GenericKey<32>, RID, GenericComparator<32>>) <= PAGE_SIZE);
+static_assert(sizeof(HashTableBucketPage<GenericKey<64>, RID, GenericComparator<64>>) <= PAGE_SIZE);
+
 }  // namespace bustub
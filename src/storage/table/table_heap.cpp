@@ -10,7 +10,10 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <cassert>
+#include <numeric>
+#include <vector>
 
 #include "common/logger.h"
 #include "storage/table/table_heap.h"
@@ -169,6 +172,52 @@ auto TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn) -> bool
   return res;
 }
 
+auto TableHeap::GetTuples(const std::vector<RID> &rids, std::vector<Tuple> *tuples, std::vector<bool> *found,
+                          Transaction *txn) -> bool {
+  tuples->assign(rids.size(), Tuple{});
+  found->assign(rids.size(), false);
+  // Visit the rids ordered by page, so the tuples of a page are read under one fetch.
+  std::vector<size_t> order(rids.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&rids](size_t lhs, size_t rhs) {
+    return rids[lhs].GetPageId() != rids[rhs].GetPageId() ? rids[lhs].GetPageId() < rids[rhs].GetPageId()
+                                                          : rids[lhs].GetSlotNum() < rids[rhs].GetSlotNum();
+  });
+  for (size_t i = 0; i < order.size();) {
+    page_id_t page_id = rids[order[i]].GetPageId();
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (page == nullptr) {
+      txn->SetState(TransactionState::ABORTED);
+      return false;
+    }
+    page->RLatch();
+    for (; i < order.size() && rids[order[i]].GetPageId() == page_id; i++) {
+      (*found)[order[i]] = page->GetTuple(rids[order[i]], &(*tuples)[order[i]], txn, lock_manager_);
+    }
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+  }
+  return true;
+}
+
+auto TableHeap::GetPageRids(page_id_t page_id, std::vector<RID> *rids, page_id_t *next_page_id, Transaction *txn)
+    -> bool {
+  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+  if (page == nullptr) {
+    txn->SetState(TransactionState::ABORTED);
+    return false;
+  }
+  page->RLatch();
+  RID rid;
+  for (bool found = page->GetFirstTupleRid(&rid); found; found = page->GetNextTupleRid(rid, &rid)) {
+    rids->push_back(rid);
+  }
+  *next_page_id = page->GetNextPageId();
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  return true;
+}
+
 auto TableHeap::Begin(Transaction *txn) -> TableIterator {
   // Start an iterator from the first page.
   // TODO(Wuwen): Hacky fix for now. Removing empty pages is a better way to handle this.
@@ -25,9 +25,13 @@ Tuple::Tuple(std::vector<Value> values, const Schema *schema) : allocated_(true)
   assert(values.size() == schema->GetColumnCount());
 
   // 1. Calculate the size of the tuple.
+  // a NULL varchar is stored as its length alone, which is BUSTUB_VALUE_NULL
+  auto varlen_size = [](const Value &value) -> uint32_t {
+    return (value.IsNull() ? 0 : value.GetLength()) + sizeof(uint32_t);
+  };
   uint32_t tuple_size = schema->GetLength();
   for (auto &i : schema->GetUnlinedColumns()) {
-    tuple_size += (values[i].GetLength() + sizeof(uint32_t));
+    tuple_size += varlen_size(values[i]);
   }
 
   // 2. Allocate memory.
@@ -46,7 +50,7 @@ Tuple::Tuple(std::vector<Value> values, const Schema *schema) : allocated_(true)
       *reinterpret_cast<uint32_t *>(data_ + col.GetOffset()) = offset;
       // Serialize varchar value, in place (size+data).
       values[i].SerializeTo(data_ + offset);
-      offset += (values[i].GetLength() + sizeof(uint32_t));
+      offset += varlen_size(values[i]);
     } else {
       values[i].SerializeTo(data_ + col.GetOffset());
     }
@@ -87,6 +91,30 @@ auto Tuple::operator=(const Tuple &other) -> Tuple & {
   return *this;
 }
 
+Tuple::Tuple(Tuple &&other) noexcept
+    : allocated_(other.allocated_), rid_(other.rid_), size_(other.size_), data_(other.data_) {
+  other.allocated_ = false;
+  other.size_ = 0;
+  other.data_ = nullptr;
+}
+
+auto Tuple::operator=(Tuple &&other) noexcept -> Tuple & {
+  if (this == &other) {
+    return *this;
+  }
+  if (allocated_) {
+    delete[] data_;
+  }
+  allocated_ = other.allocated_;
+  rid_ = other.rid_;
+  size_ = other.size_;
+  data_ = other.data_;
+  other.allocated_ = false;
+  other.size_ = 0;
+  other.data_ = nullptr;
+  return *this;
+}
+
 auto Tuple::GetValue(const Schema *schema, const uint32_t column_idx) const -> Value {
   assert(schema);
   assert(data_);
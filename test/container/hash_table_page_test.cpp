@@ -114,4 +114,45 @@ TEST(HashTablePageTest, BucketPageSampleTest) {
   delete bpm;
 }
 
+// NOLINTNEXTLINE
+TEST(HashTablePageTest, BucketPageFullTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(5, disk_manager);
+
+  page_id_t bucket_page_id = INVALID_PAGE_ID;
+  auto bucket_page = reinterpret_cast<HashTableBucketPage<int, int, IntComparator> *>(
+      bpm->NewPage(&bucket_page_id, nullptr)->GetData());
+
+  // fill the bucket, every key twice with different values
+  int num_slots = 0;
+  for (int i = 0; bucket_page->Insert(i / 2, i, IntComparator()); i++) {
+    num_slots++;
+  }
+  EXPECT_TRUE(bucket_page->IsFull());
+  EXPECT_EQ(num_slots, bucket_page->NumReadable());
+
+  // every key is found with exactly its own values, despite fingerprint collisions
+  for (int i = 0; i < num_slots; i += 2) {
+    std::vector<int> res;
+    EXPECT_TRUE(bucket_page->GetValue(i / 2, IntComparator(), &res));
+    EXPECT_EQ(i + 1 < num_slots ? 2 : 1, res.size());
+    EXPECT_EQ(i, res[0]);
+  }
+  std::vector<int> res;
+  EXPECT_FALSE(bucket_page->GetValue(num_slots, IntComparator(), &res));
+
+  // a removed slot is reused by the next insert
+  EXPECT_TRUE(bucket_page->Remove(3, 7, IntComparator()));
+  EXPECT_FALSE(bucket_page->IsReadable(7));
+  EXPECT_TRUE(bucket_page->Insert(-1, -1, IntComparator()));
+  EXPECT_EQ(-1, bucket_page->KeyAt(7));
+  EXPECT_TRUE(bucket_page->IsFull());
+
+  bpm->UnpinPage(bucket_page_id, true, nullptr);
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
 }  // namespace bustub
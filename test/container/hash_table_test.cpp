@@ -11,16 +11,24 @@
 //===----------------------------------------------------------------------===//
 
 #include <thread>  // NOLINT
+#include <utility>
 #include <vector>
 
 #include "buffer/buffer_pool_manager_instance.h"
 #include "common/logger.h"
+#include "catalog/schema.h"
 #include "container/hash/extendible_hash_table.h"
 #include "gtest/gtest.h"
 #include "murmur3/MurmurHash3.h"
 
 namespace bustub {
 
+// the number of pairs a bucket page of a table holds
+template <typename KeyType, typename ValueType>
+constexpr auto BucketArraySize() -> int {
+  return static_cast<int>(BUCKET_ARRAY_SIZE);
+}
+
 // NOLINTNEXTLINE
 
 // NOLINTNEXTLINE
@@ -236,4 +244,252 @@ TEST(HashTableTest, SampleTest3) {
   delete bpm;
 }
 
+TEST(HashTableTest, ConcurrentInsertTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  const int num_threads = 4;
+  const int keys_per_thread = BucketArraySize<int, int>() * 2;
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&ht, tid]() {
+      for (int i = tid * keys_per_thread; i < (tid + 1) * keys_per_thread; i++) {
+        EXPECT_TRUE(ht.Insert(nullptr, i, i));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ht.VerifyIntegrity();
+
+  for (int i = 0; i < num_threads * keys_per_thread; i++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    EXPECT_EQ(1, res.size()) << "Failed to keep " << i << std::endl;
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+TEST(HashTableTest, ConcurrentLookupDuringSplitTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  // the keys inserted up front must stay visible while the directory keeps growing
+  const int num_stable_keys = BucketArraySize<int, int>();
+  for (int i = 0; i < num_stable_keys; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+  }
+  std::thread writer([&ht]() {
+    for (int i = num_stable_keys; i < num_stable_keys * 8; i++) {
+      EXPECT_TRUE(ht.Insert(nullptr, i, i));
+    }
+  });
+  std::vector<std::thread> readers;
+  for (int tid = 0; tid < 2; tid++) {
+    readers.emplace_back([&ht]() {
+      for (int round = 0; round < 4; round++) {
+        for (int i = 0; i < num_stable_keys; i++) {
+          std::vector<int> res;
+          ht.GetValue(nullptr, i, &res);
+          EXPECT_EQ(1, res.size()) << "Lost " << i << " during a split" << std::endl;
+        }
+      }
+    });
+  }
+  writer.join();
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  ht.VerifyIntegrity();
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+TEST(HashTableTest, OverflowChainTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  // far more values for one key than a bucket page holds, they can never be split apart
+  const int bucket_size = BucketArraySize<int, int>();
+  const int num_duplicates = bucket_size * 3;
+  for (int i = 0; i < num_duplicates; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, 0, i));
+  }
+  EXPECT_FALSE(ht.Insert(nullptr, 0, 0));
+  EXPECT_EQ(0, ht.GetGlobalDepth());
+
+  // other keys still split the directory, carrying the chain along
+  for (int i = 1; i < bucket_size * 2; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+  }
+  ht.VerifyIntegrity();
+
+  std::vector<int> res;
+  ht.GetValue(nullptr, 0, &res);
+  EXPECT_EQ(num_duplicates, res.size());
+  for (int i = 1; i < bucket_size * 2; i++) {
+    res.clear();
+    ht.GetValue(nullptr, i, &res);
+    EXPECT_EQ(1, res.size()) << "Failed to keep " << i << std::endl;
+  }
+
+  // shrink the chain again
+  for (int i = 0; i < num_duplicates; i++) {
+    EXPECT_TRUE(ht.Remove(nullptr, 0, i));
+  }
+  res.clear();
+  EXPECT_FALSE(ht.GetValue(nullptr, 0, &res));
+  for (int i = 1; i < bucket_size * 2; i++) {
+    EXPECT_TRUE(ht.Remove(nullptr, i, i));
+  }
+  ht.VerifyIntegrity();
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+TEST(HashTableTest, BulkLoadTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  // many distinct keys, plus one key with more values than a bucket holds
+  const int bucket_size = BucketArraySize<int, int>();
+  const int num_keys = bucket_size * 20;
+  std::vector<std::pair<int, int>> pairs;
+  for (int i = 0; i < num_keys; i++) {
+    pairs.emplace_back(i, i);
+  }
+  for (int i = 0; i < bucket_size * 2; i++) {
+    pairs.emplace_back(-1, i);
+  }
+  EXPECT_TRUE(ht.BulkLoad(nullptr, pairs));
+  ht.VerifyIntegrity();
+  EXPECT_GT(ht.GetGlobalDepth(), 0);
+
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    EXPECT_EQ(1, res.size()) << "Failed to load " << i << std::endl;
+  }
+  std::vector<int> res;
+  ht.GetValue(nullptr, -1, &res);
+  EXPECT_EQ(bucket_size * 2, res.size());
+
+  // the bulk loaded table keeps working as usual
+  EXPECT_FALSE(ht.Insert(nullptr, 0, 0));
+  for (int i = num_keys; i < num_keys + bucket_size; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+  }
+  for (int i = 0; i < num_keys + bucket_size; i++) {
+    EXPECT_TRUE(ht.Remove(nullptr, i, i));
+  }
+  ht.VerifyIntegrity();
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+TEST(HashTableTest, GenericKeyHashTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+
+  // a single integer column only fills the first 4 bytes of the key
+  std::vector<Column> columns{};
+  columns.emplace_back("A", TypeId::INTEGER);
+  Schema key_schema{columns};
+  HashFunction<GenericKey<64>> hash_fn;
+  hash_fn.BindKeySchema(&key_schema);
+
+  GenericKey<64> key1;
+  GenericKey<64> key2;
+  key1.SetFromInteger(42);
+  key2.SetFromInteger(42);
+  EXPECT_EQ(hash_fn.GetHash(key1), hash_fn.GetHash(key2));
+  key2.SetFromInteger(43);
+  EXPECT_NE(hash_fn.GetHash(key1), hash_fn.GetHash(key2));
+
+  GenericComparator<64> comparator(&key_schema);
+  ExtendibleHashTable<GenericKey<64>, RID, GenericComparator<64>> ht("blah", bpm, comparator, hash_fn);
+  // two buckets worth of keys, which only spread out if the hash covers the key bytes
+  const int bucket_size = BucketArraySize<GenericKey<64>, RID>();
+  for (int i = 0; i < bucket_size * 2; i++) {
+    GenericKey<64> key;
+    key.SetFromInteger(i);
+    EXPECT_TRUE(ht.Insert(nullptr, key, RID(i, i)));
+  }
+  ht.VerifyIntegrity();
+  EXPECT_GT(ht.GetGlobalDepth(), 0);
+  for (int i = 0; i < bucket_size * 2; i++) {
+    GenericKey<64> key;
+    key.SetFromInteger(i);
+    std::vector<RID> res;
+    ht.GetValue(nullptr, key, &res);
+    ASSERT_EQ(1, res.size()) << "Failed to keep " << i << std::endl;
+    EXPECT_EQ(RID(i, i), res[0]);
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+TEST(HashTableTest, IteratorTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  EXPECT_TRUE(ht.Begin() == ht.End());
+
+  // enough keys for several buckets shared by several directory slots, plus an overflow chain
+  const int bucket_size = BucketArraySize<int, int>();
+  const int num_keys = bucket_size * 4;
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+  }
+  for (int i = 1; i < bucket_size * 2; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, 0, -i));
+  }
+  for (int i = 0; i < num_keys; i += 4) {
+    EXPECT_TRUE(ht.Remove(nullptr, i + 1, i + 1));
+  }
+
+  std::vector<int> seen(num_keys, 0);
+  int num_duplicates = 0;
+  for (auto iter = ht.Begin(); iter != ht.End(); ++iter) {
+    if ((*iter).second < 0) {
+      EXPECT_EQ(0, (*iter).first);
+      num_duplicates++;
+    } else {
+      EXPECT_EQ((*iter).first, (*iter).second);
+      seen[(*iter).first]++;
+    }
+  }
+  EXPECT_EQ(bucket_size * 2 - 1, num_duplicates);
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_EQ(i % 4 == 1 ? 0 : 1, seen[i]) << "Wrong visits of " << i << std::endl;
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
 }  // namespace bustub
@@ -0,0 +1,185 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// column_vector_test.cpp
+//
+// Identification: test/execution/column_vector_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <string>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "execution/column_vector.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "gtest/gtest.h"
+#include "storage/table/tuple.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+static const std::vector<ComparisonType> COMPARISON_TYPES{
+    ComparisonType::Equal,           ComparisonType::NotEqual,    ComparisonType::LessThan,
+    ComparisonType::LessThanOrEqual, ComparisonType::GreaterThan, ComparisonType::GreaterThanOrEqual};
+
+// The rows where the comparison of the values of two columns is true, compared value by value
+static auto ExpectedSelection(const std::vector<Value> &lhs, const std::vector<Value> &rhs, ComparisonType comp_type)
+    -> SelectionVector {
+  SelectionVector selection;
+  for (uint32_t i = 0; i < lhs.size(); i++) {
+    CmpBool result = CmpBool::CmpFalse;
+    switch (comp_type) {
+      case ComparisonType::Equal:
+        result = lhs[i].CompareEquals(rhs[i]);
+        break;
+      case ComparisonType::NotEqual:
+        result = lhs[i].CompareNotEquals(rhs[i]);
+        break;
+      case ComparisonType::LessThan:
+        result = lhs[i].CompareLessThan(rhs[i]);
+        break;
+      case ComparisonType::LessThanOrEqual:
+        result = lhs[i].CompareLessThanEquals(rhs[i]);
+        break;
+      case ComparisonType::GreaterThan:
+        result = lhs[i].CompareGreaterThan(rhs[i]);
+        break;
+      case ComparisonType::GreaterThanOrEqual:
+        result = lhs[i].CompareGreaterThanEquals(rhs[i]);
+        break;
+    }
+    if (result == CmpBool::CmpTrue) {
+      selection.push_back(i);
+    }
+  }
+  return selection;
+}
+
+static auto AllRows(size_t size) -> SelectionVector {
+  SelectionVector selection(size);
+  for (uint32_t i = 0; i < size; i++) {
+    selection[i] = i;
+  }
+  return selection;
+}
+
+// NOLINTNEXTLINE
+TEST(ColumnVectorTest, AppendTest) {
+  // a NULL varchar in front of another varchar checks that it is serialized as its length alone
+  Schema schema{{Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 16}, Column{"c", TypeId::DECIMAL},
+                 Column{"d", TypeId::VARCHAR, 16}}};
+  std::vector<Tuple> tuples;
+  for (int32_t i = 0; i < 200; i++) {
+    Value b = i % 7 == 0 ? ValueFactory::GetNullValueByType(TypeId::VARCHAR)
+                         : ValueFactory::GetVarcharValue(std::string(i % 5, 'x'));
+    Value c = i % 9 == 0 ? ValueFactory::GetNullValueByType(TypeId::DECIMAL) : ValueFactory::GetDecimalValue(i * 0.5);
+    Value d = i % 11 == 0 ? ValueFactory::GetNullValueByType(TypeId::VARCHAR)
+                          : ValueFactory::GetVarcharValue(std::string(i % 3 + 1, 'y'));
+    tuples.emplace_back(std::vector<Value>{ValueFactory::GetIntegerValue(i), b, c, d}, &schema);
+  }
+
+  for (uint32_t col_idx = 0; col_idx < schema.GetColumnCount(); col_idx++) {
+    ColumnVector column{schema.GetColumn(col_idx).GetType()};
+    for (const auto &tuple : tuples) {
+      column.Append(tuple, &schema, col_idx);
+    }
+    ASSERT_EQ(column.Size(), tuples.size());
+    ASSERT_EQ(column.HasNull(), col_idx != 0);
+    for (size_t i = 0; i < tuples.size(); i++) {
+      Value expected = tuples[i].GetValue(&schema, col_idx);
+      Value value = column.GetValue(i);
+      ASSERT_EQ(column.IsNull(i), expected.IsNull()) << "column " << col_idx << " row " << i;
+      if (!expected.IsNull()) {
+        ASSERT_EQ(value.CompareEquals(expected), CmpBool::CmpTrue) << "column " << col_idx << " row " << i;
+      }
+    }
+  }
+
+  // appending values stores them the same way
+  ColumnVector column{TypeId::INTEGER};
+  column.Append(ValueFactory::GetIntegerValue(7));
+  column.AppendNull();
+  ASSERT_EQ(column.GetData<int32_t>()[0], 7);
+  ASSERT_FALSE(column.IsNull(0));
+  ASSERT_TRUE(column.IsNull(1));
+  ASSERT_TRUE(column.GetValue(1).IsNull());
+  column.Clear();
+  ASSERT_EQ(column.Size(), 0);
+  ASSERT_FALSE(column.HasNull());
+}
+
+// NOLINTNEXTLINE
+TEST(ColumnVectorTest, EvaluateBatchTest) {
+  const size_t size = 300;
+  std::vector<ColumnVector> columns{ColumnVector{TypeId::INTEGER}, ColumnVector{TypeId::INTEGER},
+                                    ColumnVector{TypeId::VARCHAR}};
+  std::vector<std::vector<Value>> values(columns.size());
+  for (size_t i = 0; i < size; i++) {
+    values[0].push_back(i % 11 == 0 ? ValueFactory::GetNullValueByType(TypeId::INTEGER)
+                                    : ValueFactory::GetIntegerValue(static_cast<int32_t>(i % 100)));
+    values[1].push_back(ValueFactory::GetIntegerValue(static_cast<int32_t>((i * 7) % 100)));
+    std::string str(1 + i % 3, static_cast<char>('a' + i % 4));
+    values[2].push_back(i % 13 == 0 ? ValueFactory::GetNullValueByType(TypeId::VARCHAR)
+                                    : ValueFactory::GetVarcharValue(str));
+    for (size_t col_idx = 0; col_idx < columns.size(); col_idx++) {
+      columns[col_idx].Append(values[col_idx].back());
+    }
+  }
+
+  ColumnValueExpression col_a{0, 0, TypeId::INTEGER};
+  ColumnValueExpression col_b{0, 1, TypeId::INTEGER};
+  ColumnValueExpression col_c{0, 2, TypeId::VARCHAR};
+  std::vector<Value> constants{ValueFactory::GetIntegerValue(42), ValueFactory::GetSmallIntValue(42),
+                               ValueFactory::GetBigIntValue(-5), ValueFactory::GetDecimalValue(41.5)};
+  for (ComparisonType comp_type : COMPARISON_TYPES) {
+    // a column with constants of every numeric type, on either side of the comparison
+    for (const Value &constant : constants) {
+      ConstantValueExpression constant_expr{constant};
+      std::vector<Value> constant_values(size, constant);
+
+      SelectionVector selection = AllRows(size);
+      ASSERT_TRUE(ComparisonExpression(&col_a, &constant_expr, comp_type).EvaluateBatch(columns, &selection));
+      ASSERT_EQ(selection, ExpectedSelection(values[0], constant_values, comp_type));
+
+      selection = AllRows(size);
+      ASSERT_TRUE(ComparisonExpression(&constant_expr, &col_a, comp_type).EvaluateBatch(columns, &selection));
+      ASSERT_EQ(selection, ExpectedSelection(constant_values, values[0], comp_type));
+    }
+
+    // two columns, starting from a selection of every other row
+    SelectionVector selection;
+    std::vector<Value> lhs;
+    std::vector<Value> rhs;
+    for (uint32_t i = 0; i < size; i += 2) {
+      selection.push_back(i);
+      lhs.push_back(values[0][i]);
+      rhs.push_back(values[1][i]);
+    }
+    SelectionVector expected;
+    for (uint32_t i : ExpectedSelection(lhs, rhs, comp_type)) {
+      expected.push_back(i * 2);
+    }
+    ASSERT_TRUE(ComparisonExpression(&col_a, &col_b, comp_type).EvaluateBatch(columns, &selection));
+    ASSERT_EQ(selection, expected);
+
+    // strings
+    ConstantValueExpression string_expr{ValueFactory::GetVarcharValue("bb")};
+    std::vector<Value> string_values(size, ValueFactory::GetVarcharValue("bb"));
+    selection = AllRows(size);
+    ASSERT_TRUE(ComparisonExpression(&col_c, &string_expr, comp_type).EvaluateBatch(columns, &selection));
+    ASSERT_EQ(selection, ExpectedSelection(values[2], string_values, comp_type));
+  }
+
+  // comparisons of different types are left to row by row evaluation
+  SelectionVector selection = AllRows(size);
+  ASSERT_FALSE(ComparisonExpression(&col_a, &col_c, ComparisonType::Equal).EvaluateBatch(columns, &selection));
+  ASSERT_EQ(selection, AllRows(size));
+}
+
+}  // namespace bustub
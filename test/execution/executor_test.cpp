@@ -10,6 +10,9 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <map>
 #include <memory>
 #include <numeric>
 #include <string>
@@ -18,12 +21,15 @@
 #include <vector>
 
 #include "buffer/buffer_pool_manager_instance.h"
+#include "common/logger.h"
 #include "concurrency/transaction_manager.h"
 #include "execution/execution_engine.h"
 #include "execution/executor_context.h"
 #include "execution/executors/aggregation_executor.h"
+#include "execution/executors/hash_join_executor.h"
 #include "execution/executors/insert_executor.h"
 #include "execution/executors/nested_loop_join_executor.h"
+#include "execution/executors/seq_scan_executor.h"
 #include "execution/expressions/aggregate_value_expression.h"
 #include "execution/expressions/column_value_expression.h"
 #include "execution/expressions/comparison_expression.h"
@@ -31,7 +37,9 @@
 #include "execution/plans/delete_plan.h"
 #include "execution/plans/distinct_plan.h"
 #include "execution/plans/hash_join_plan.h"
+#include "execution/plans/index_scan_plan.h"
 #include "execution/plans/limit_plan.h"
+#include "execution/plans/nested_index_join_plan.h"
 #include "execution/plans/seq_scan_plan.h"
 #include "execution/plans/update_plan.h"
 #include "executor_test_util.h"  // NOLINT
@@ -46,15 +54,18 @@
  * particular, the tests in this file include:
  *
  * - Sequential Scan
+ * - Index Scan
  * - Insert (Raw)
  * - Insert (Select)
  * - Update
  * - Delete
  * - Nested Loop Join
+ * - Nested Index Join
  * - Hash Join
  * - Aggregation
  * - Limit
  * - Distinct
+ * - Batch execution
  *
  * Each of the tests demonstrates how to construct a query plan for
  * a particular executors. Students should be able to learn from and
@@ -110,6 +121,195 @@ TEST_F(ExecutorTest, SimpleSeqScanTest) {
   }
 }
 
+// SELECT col_a, col_b FROM test_1 WHERE col_a < 500, and SELECT col_b FROM test_1 WHERE col_b < 5, with indexes
+TEST_F(ExecutorTest, SimpleIndexScanTest) {
+  TableInfo *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  const Schema &schema = table_info->schema_;
+  auto *col_a = MakeColumnValueExpression(schema, 0, "colA");
+  auto *col_b = MakeColumnValueExpression(schema, 0, "colB");
+  auto key_schema = ParseCreateStatement("a integer");
+  ComparatorType comparator{key_schema.get()};
+  // a B+ tree index needs room for the rid behind the key
+  auto *index_a = GetExecutorContext()->GetCatalog()->CreateIndex<GenericKey<16>, ValueType, GenericComparator<16>>(
+      GetTxn(), "index_a", "test_1", schema, *key_schema, {0}, 16, HashFunction<GenericKey<16>>{},
+      IndexType::BPlusTreeIndex);
+  auto *index_b = GetExecutorContext()->GetCatalog()->CreateIndex<GenericKey<16>, ValueType, GenericComparator<16>>(
+      GetTxn(), "index_b", "test_1", schema, *key_schema, {1}, 16, HashFunction<GenericKey<16>>{},
+      IndexType::BPlusTreeIndex);
+
+  // colB is not in index_a, so the tuples are read from the table heap
+  auto *const500 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(500));
+  auto *predicate_a = MakeComparisonExpression(col_a, const500, ComparisonType::LessThan);
+  auto *out_schema_a = MakeOutputSchema({{"colA", col_a}, {"colB", col_b}});
+  IndexScanPlanNode plan_a{out_schema_a, predicate_a, index_a->index_oid_};
+  std::vector<Tuple> result_set{};
+  GetExecutionEngine()->Execute(&plan_a, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), 500);
+  for (int32_t i = 0; i < 500; i++) {
+    ASSERT_EQ(result_set[i].GetValue(out_schema_a, out_schema_a->GetColIdx("colA")).GetAs<int32_t>(), i);
+    ASSERT_TRUE(result_set[i].GetValue(out_schema_a, out_schema_a->GetColIdx("colB")).GetAs<int32_t>() < 10);
+  }
+
+  // index_b covers the query, the duplicate keys are returned in key order
+  auto *const5 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(5));
+  auto *predicate_b = MakeComparisonExpression(col_b, const5, ComparisonType::LessThan);
+  auto *out_schema_b = MakeOutputSchema({{"colB", col_b}});
+  IndexScanPlanNode plan_b{out_schema_b, predicate_b, index_b->index_oid_};
+  result_set.clear();
+  GetExecutionEngine()->Execute(&plan_b, &result_set, GetTxn(), GetExecutorContext());
+
+  SeqScanPlanNode seq_plan{out_schema_b, predicate_b, table_info->oid_};
+  std::vector<Tuple> seq_result_set{};
+  GetExecutionEngine()->Execute(&seq_plan, &seq_result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), seq_result_set.size());
+  std::vector<int32_t> expected;
+  for (const auto &tuple : seq_result_set) {
+    expected.push_back(tuple.GetValue(out_schema_b, 0).GetAs<int32_t>());
+  }
+  std::sort(expected.begin(), expected.end());
+  for (size_t i = 0; i < result_set.size(); i++) {
+    ASSERT_EQ(result_set[i].GetValue(out_schema_b, 0).GetAs<int32_t>(), expected[i]);
+  }
+}
+
+// SELECT col_a, col_b FROM test_1 WHERE col_a >= 990, WHERE 7 = col_a and WHERE col_b <= 9, with indexes
+TEST_F(ExecutorTest, SimpleIndexRangeScanTest) {
+  TableInfo *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  const Schema &schema = table_info->schema_;
+  auto *col_a = MakeColumnValueExpression(schema, 0, "colA");
+  auto *col_b = MakeColumnValueExpression(schema, 0, "colB");
+  auto *out_schema = MakeOutputSchema({{"colA", col_a}, {"colB", col_b}});
+  auto key_schema = ParseCreateStatement("a integer");
+  ComparatorType comparator{key_schema.get()};
+  auto *index_a = GetExecutorContext()->GetCatalog()->CreateIndex<GenericKey<16>, ValueType, GenericComparator<16>>(
+      GetTxn(), "index_a", "test_1", schema, *key_schema, {0}, 16, HashFunction<GenericKey<16>>{},
+      IndexType::BPlusTreeIndex);
+  auto *index_b = GetExecutorContext()->GetCatalog()->CreateIndex<GenericKey<16>, ValueType, GenericComparator<16>>(
+      GetTxn(), "index_b", "test_1", schema, *key_schema, {1}, 16, HashFunction<GenericKey<16>>{},
+      IndexType::BPlusTreeIndex);
+
+  // the lower bound skips the keys below 990
+  auto *const990 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(990));
+  auto *predicate = MakeComparisonExpression(col_a, const990, ComparisonType::GreaterThanOrEqual);
+  IndexScanPlanNode plan{out_schema, predicate, index_a->index_oid_};
+  std::vector<Tuple> result_set{};
+  GetExecutionEngine()->Execute(&plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), 10);
+  for (int32_t i = 0; i < 10; i++) {
+    ASSERT_EQ(result_set[i].GetValue(out_schema, out_schema->GetColIdx("colA")).GetAs<int32_t>(), 990 + i);
+  }
+
+  // the constant may come first
+  auto *const7 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(7));
+  auto *point_predicate = MakeComparisonExpression(const7, col_a, ComparisonType::Equal);
+  IndexScanPlanNode point_plan{out_schema, point_predicate, index_a->index_oid_};
+  result_set.clear();
+  GetExecutionEngine()->Execute(&point_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), 1);
+  ASSERT_EQ(result_set[0].GetValue(out_schema, out_schema->GetColIdx("colA")).GetAs<int32_t>(), 7);
+
+  // the tuples are read in several batches, but returned in the order of (colB, rid)
+  auto *const9 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(9));
+  auto *range_predicate = MakeComparisonExpression(col_b, const9, ComparisonType::LessThanOrEqual);
+  IndexScanPlanNode range_plan{out_schema, range_predicate, index_b->index_oid_};
+  result_set.clear();
+  GetExecutionEngine()->Execute(&range_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), 1000);
+  for (size_t i = 1; i < result_set.size(); i++) {
+    int32_t prev_b = result_set[i - 1].GetValue(out_schema, out_schema->GetColIdx("colB")).GetAs<int32_t>();
+    int32_t b = result_set[i].GetValue(out_schema, out_schema->GetColIdx("colB")).GetAs<int32_t>();
+    ASSERT_LE(prev_b, b);
+    if (prev_b == b) {
+      ASSERT_LT(result_set[i - 1].GetValue(out_schema, out_schema->GetColIdx("colA")).GetAs<int32_t>(),
+                result_set[i].GetValue(out_schema, out_schema->GetColIdx("colA")).GetAs<int32_t>());
+    }
+  }
+}
+
+// SELECT colA, colB FROM test_1 WHERE colB ... with an index on (colB, colA)
+TEST_F(ExecutorTest, MultiColumnIndexRangeScanTest) {
+  TableInfo *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  const Schema &schema = table_info->schema_;
+  auto *col_a = MakeColumnValueExpression(schema, 0, "colA");
+  auto *col_b = MakeColumnValueExpression(schema, 0, "colB");
+  auto *out_schema = MakeOutputSchema({{"colA", col_a}, {"colB", col_b}});
+  auto key_schema = ParseCreateStatement("b integer,a integer");
+  auto *index_ba = GetExecutorContext()->GetCatalog()->CreateIndex<GenericKey<16>, ValueType, GenericComparator<16>>(
+      GetTxn(), "index_ba", "test_1", schema, *key_schema, {1, 0}, 16, HashFunction<GenericKey<16>>{},
+      IndexType::BPlusTreeIndex);
+
+  // the bounds leave colA NULL, every value of colB spreads over a leaf boundary or two of the 1000 entries
+  auto check = [&](ComparisonType comparison_type, int32_t b) {
+    auto *constant = MakeConstantValueExpression(ValueFactory::GetIntegerValue(b));
+    auto *predicate = MakeComparisonExpression(col_b, constant, comparison_type);
+    SeqScanPlanNode seq_plan{out_schema, predicate, table_info->oid_};
+    std::vector<Tuple> expected{};
+    GetExecutionEngine()->Execute(&seq_plan, &expected, GetTxn(), GetExecutorContext());
+    IndexScanPlanNode index_plan{out_schema, predicate, index_ba->index_oid_};
+    std::vector<Tuple> result_set{};
+    GetExecutionEngine()->Execute(&index_plan, &result_set, GetTxn(), GetExecutorContext());
+    ASSERT_EQ(result_set.size(), expected.size());
+    for (size_t i = 1; i < result_set.size(); i++) {
+      int32_t prev_b = result_set[i - 1].GetValue(out_schema, out_schema->GetColIdx("colB")).GetAs<int32_t>();
+      int32_t cur_b = result_set[i].GetValue(out_schema, out_schema->GetColIdx("colB")).GetAs<int32_t>();
+      ASSERT_TRUE(prev_b < cur_b ||
+                  (prev_b == cur_b &&
+                   result_set[i - 1].GetValue(out_schema, out_schema->GetColIdx("colA")).GetAs<int32_t>() <
+                       result_set[i].GetValue(out_schema, out_schema->GetColIdx("colA")).GetAs<int32_t>()));
+    }
+  };
+  for (int32_t b = 0; b < 10; b++) {
+    check(ComparisonType::Equal, b);
+  }
+  check(ComparisonType::GreaterThanOrEqual, 4);
+  check(ComparisonType::GreaterThan, 4);
+  check(ComparisonType::LessThan, 6);
+  check(ComparisonType::LessThanOrEqual, 6);
+}
+
+// SELECT colA FROM varchar_table WHERE colA >= 'a_long_common_prefix_25', with an index that cuts the keys off
+TEST_F(ExecutorTest, VarcharIndexScanTest) {
+  Schema schema{{Column{"colA", TypeId::VARCHAR, 64}, Column{"colB", TypeId::INTEGER}}};
+  auto *table_info = GetExecutorContext()->GetCatalog()->CreateTable(GetTxn(), "varchar_table", schema);
+  std::vector<std::vector<Value>> raw_vals;
+  for (int32_t i = 0; i < 200; i++) {
+    // the strings only differ behind the 16 characters the keys keep
+    raw_vals.push_back({ValueFactory::GetVarcharValue("a_long_common_prefix_" + std::to_string(i % 50)),
+                        ValueFactory::GetIntegerValue(i)});
+  }
+  InsertPlanNode insert_plan{std::move(raw_vals), table_info->oid_};
+  GetExecutionEngine()->Execute(&insert_plan, nullptr, GetTxn(), GetExecutorContext());
+  Schema key_schema{{Column{"colA", TypeId::VARCHAR, 64}}};
+  auto *index_info = GetExecutorContext()->GetCatalog()->CreateIndex<GenericKey<32>, ValueType, GenericComparator<32>>(
+      GetTxn(), "varchar_index", "varchar_table", table_info->schema_, key_schema, {0}, 32,
+      HashFunction<GenericKey<32>>{}, IndexType::BPlusTreeIndex);
+
+  // only colA is read, but the strings are taken from the table heap rather than from the cut off keys
+  auto *col_a = MakeColumnValueExpression(table_info->schema_, 0, "colA");
+  auto *constant = MakeConstantValueExpression(ValueFactory::GetVarcharValue("a_long_common_prefix_25"));
+  auto *predicate = MakeComparisonExpression(col_a, constant, ComparisonType::GreaterThanOrEqual);
+  auto *out_schema = MakeOutputSchema({{"colA", col_a}});
+  IndexScanPlanNode plan{out_schema, predicate, index_info->index_oid_};
+  std::vector<Tuple> result_set{};
+  GetExecutionEngine()->Execute(&plan, &result_set, GetTxn(), GetExecutorContext());
+
+  SeqScanPlanNode seq_plan{out_schema, predicate, table_info->oid_};
+  std::vector<Tuple> seq_result_set{};
+  GetExecutionEngine()->Execute(&seq_plan, &seq_result_set, GetTxn(), GetExecutorContext());
+  std::vector<std::string> actual;
+  std::vector<std::string> expected;
+  for (const auto &tuple : result_set) {
+    actual.push_back(tuple.GetValue(out_schema, 0).ToString());
+  }
+  for (const auto &tuple : seq_result_set) {
+    expected.push_back(tuple.GetValue(out_schema, 0).ToString());
+  }
+  std::sort(actual.begin(), actual.end());
+  std::sort(expected.begin(), expected.end());
+  ASSERT_FALSE(expected.empty());
+  ASSERT_EQ(actual, expected);
+}
+
 // INSERT INTO empty_table2 VALUES (100, 10), (101, 11), (102, 12)
 TEST_F(ExecutorTest, SimpleRawInsertTest) {
   // Create Values to insert
@@ -417,6 +617,74 @@ TEST_F(ExecutorTest, SimpleNestedLoopJoinTest) {
   ASSERT_EQ(result_set.size(), 100);
 }
 
+// SELECT test_1.colA, test_1.colB, test_2.col1, test_2.col3 FROM test_1 JOIN test_2 ON test_1.colA = test_2.col1, and
+// SELECT test_1.colB, test_7.colA, test_7.colC FROM test_1 JOIN test_7 ON test_1.colB = test_7.colC, with indexes
+TEST_F(ExecutorTest, SimpleNestedIndexJoinTest) {
+  auto *outer_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto *col_a = MakeColumnValueExpression(outer_info->schema_, 0, "colA");
+  auto *col_b = MakeColumnValueExpression(outer_info->schema_, 0, "colB");
+  auto *outer_schema = MakeOutputSchema({{"colA", col_a}, {"colB", col_b}});
+  SeqScanPlanNode outer_plan{outer_schema, nullptr, outer_info->oid_};
+
+  // the outer key is cast to the smallint key of the B+ tree index, and the joined tuples follow the outer order
+  auto *inner_info = GetExecutorContext()->GetCatalog()->GetTable("test_2");
+  auto key_schema = ParseCreateStatement("a smallint");
+  ComparatorType comparator{key_schema.get()};
+  GetExecutorContext()->GetCatalog()->CreateIndex<GenericKey<16>, ValueType, GenericComparator<16>>(
+      GetTxn(), "index1", "test_2", inner_info->schema_, *key_schema, {0}, 16, HashFunction<GenericKey<16>>{},
+      IndexType::BPlusTreeIndex);
+  auto *col1 = MakeColumnValueExpression(inner_info->schema_, 1, "col1");
+  auto *col3 = MakeColumnValueExpression(inner_info->schema_, 1, "col3");
+  auto *out_schema = MakeOutputSchema({{"colA", col_a}, {"colB", col_b}, {"col1", col1}, {"col3", col3}});
+  NestedIndexJoinPlanNode join_plan{out_schema,
+                                    {&outer_plan},
+                                    MakeComparisonExpression(col_a, col1, ComparisonType::Equal),
+                                    inner_info->oid_,
+                                    "index1",
+                                    outer_schema,
+                                    &inner_info->schema_};
+  std::vector<Tuple> result_set{};
+  GetExecutionEngine()->Execute(&join_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), 100);
+  for (int32_t i = 0; i < 100; i++) {
+    ASSERT_EQ(result_set[i].GetValue(out_schema, out_schema->GetColIdx("colA")).GetAs<int32_t>(), i);
+    ASSERT_EQ(result_set[i].GetValue(out_schema, out_schema->GetColIdx("col1")).GetAs<int16_t>(), i);
+  }
+
+  // every outer tuple matches about a tenth of the inner tuples through a hash index
+  auto *dup_info = GetExecutorContext()->GetCatalog()->GetTable("test_7");
+  auto dup_key_schema = ParseCreateStatement("a integer");
+  GetExecutorContext()->GetCatalog()->CreateIndex<KeyType, ValueType, ComparatorType>(
+      GetTxn(), "index7", "test_7", dup_info->schema_, *dup_key_schema, {2}, 8, HashFunctionType{});
+  auto *dup_col_a = MakeColumnValueExpression(dup_info->schema_, 1, "colA");
+  auto *dup_col_c = MakeColumnValueExpression(dup_info->schema_, 1, "colC");
+  auto *dup_out_schema = MakeOutputSchema({{"colB", col_b}, {"colA", dup_col_a}, {"colC", dup_col_c}});
+  NestedIndexJoinPlanNode dup_join_plan{dup_out_schema,
+                                        {&outer_plan},
+                                        MakeComparisonExpression(col_b, dup_col_c, ComparisonType::Equal),
+                                        dup_info->oid_,
+                                        "index7",
+                                        outer_schema,
+                                        &dup_info->schema_};
+  result_set.clear();
+  GetExecutionEngine()->Execute(&dup_join_plan, &result_set, GetTxn(), GetExecutorContext());
+
+  // the nested loop join reads the inner columns from the output of the inner scan
+  auto *inner_scan_schema = MakeOutputSchema({{"colA", dup_col_a}, {"colC", dup_col_c}});
+  SeqScanPlanNode inner_plan{inner_scan_schema, nullptr, dup_info->oid_};
+  auto *scan_col_a = MakeColumnValueExpression(*inner_scan_schema, 1, "colA");
+  auto *scan_col_c = MakeColumnValueExpression(*inner_scan_schema, 1, "colC");
+  auto *loop_out_schema = MakeOutputSchema({{"colB", col_b}, {"colA", scan_col_a}, {"colC", scan_col_c}});
+  NestedLoopJoinPlanNode loop_join_plan{
+      loop_out_schema, {&outer_plan, &inner_plan}, MakeComparisonExpression(col_b, scan_col_c, ComparisonType::Equal)};
+  std::vector<Tuple> loop_result_set{};
+  GetExecutionEngine()->Execute(&loop_join_plan, &loop_result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), loop_result_set.size());
+  for (const auto &tuple : result_set) {
+    ASSERT_EQ(tuple.GetValue(dup_out_schema, 0).GetAs<int32_t>(), tuple.GetValue(dup_out_schema, 2).GetAs<int32_t>());
+  }
+}
+
 // SELECT test_4.colA, test_4.colB, test_6.colA, test_6.colB FROM test_4 JOIN test_6 ON test_4.colA = test_6.colA;
 TEST_F(ExecutorTest, SimpleHashJoinTest) {
   // Construct sequential scan of table test_4
@@ -619,6 +887,9 @@ TEST_F(ExecutorTest, SimpleLimitTest) {
     ASSERT_EQ(tuple.GetValue(out_schema, out_schema->GetColIdx("colA")).GetAs<int32_t>(), static_cast<int32_t>(i));
     ASSERT_EQ(tuple.GetValue(out_schema, out_schema->GetColIdx("colB")).GetAs<int32_t>(), static_cast<int32_t>(i));
   }
+
+  // the scan only reads, and locks, the tuples that the limit takes
+  ASSERT_EQ(GetTxn()->GetSharedLockSet()->size(), 10);
 }
 
 // SELECT DISTINCT colC FROM test_7
@@ -657,4 +928,110 @@ TEST_F(ExecutorTest, SimpleDistinctTest) {
   ASSERT_TRUE(std::equal(results.cbegin(), results.cend(), expected.cbegin()));
 }
 
+// Drives an executor only by Next(), so its parent sees the tuple-at-a-time interface
+class TupleAtATimeExecutor : public AbstractExecutor {
+ public:
+  explicit TupleAtATimeExecutor(std::unique_ptr<AbstractExecutor> &&child)
+      : AbstractExecutor(child->GetExecutorContext()), child_(std::move(child)) {}
+  void Init() override { child_->Init(); }
+  auto Next(Tuple *tuple, RID *rid) -> bool override { return child_->Next(tuple, rid); }
+  auto GetOutputSchema() -> const Schema * override { return child_->GetOutputSchema(); }
+
+ private:
+  std::unique_ptr<AbstractExecutor> child_;
+};
+
+// SELECT test_1.colB, COUNT(test_1.colA), SUM(t.colC) FROM test_1 JOIN test_1 t ON test_1.colA = t.colA
+// WHERE test_1.colA < 900 GROUP BY test_1.colB, executed a tuple and a batch at a time
+TEST_F(ExecutorTest, BatchExecutionBenchmarkTest) {
+  auto *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto &schema = table_info->schema_;
+  auto *col_a = MakeColumnValueExpression(schema, 0, "colA");
+  auto *col_b = MakeColumnValueExpression(schema, 0, "colB");
+  auto *col_c = MakeColumnValueExpression(schema, 0, "colC");
+  auto *left_schema = MakeOutputSchema({{"colA", col_a}, {"colB", col_b}});
+  auto *predicate = MakeComparisonExpression(col_a, MakeConstantValueExpression(ValueFactory::GetIntegerValue(900)),
+                                             ComparisonType::LessThan);
+  SeqScanPlanNode left_plan{left_schema, predicate, table_info->oid_};
+  auto *right_schema = MakeOutputSchema({{"colA", col_a}, {"colC", col_c}});
+  SeqScanPlanNode right_plan{right_schema, nullptr, table_info->oid_};
+
+  auto *left_col_a = MakeColumnValueExpression(*left_schema, 0, "colA");
+  auto *left_col_b = MakeColumnValueExpression(*left_schema, 0, "colB");
+  auto *right_col_a = MakeColumnValueExpression(*right_schema, 1, "colA");
+  auto *right_col_c = MakeColumnValueExpression(*right_schema, 1, "colC");
+  auto *join_schema = MakeOutputSchema({{"colA", left_col_a}, {"colB", left_col_b}, {"colC", right_col_c}});
+  HashJoinPlanNode join_plan{join_schema, {&left_plan, &right_plan}, left_col_a, right_col_a};
+
+  auto *join_col_a = MakeColumnValueExpression(*join_schema, 0, "colA");
+  auto *join_col_b = MakeColumnValueExpression(*join_schema, 0, "colB");
+  auto *join_col_c = MakeColumnValueExpression(*join_schema, 0, "colC");
+  auto *agg_schema = MakeOutputSchema({{"colB", MakeAggregateValueExpression(true, 0)},
+                                       {"countA", MakeAggregateValueExpression(false, 0)},
+                                       {"sumC", MakeAggregateValueExpression(false, 1)}});
+  AggregationPlanNode agg_plan{agg_schema,
+                               &join_plan,
+                               nullptr,
+                               {join_col_b},
+                               {join_col_a, join_col_c},
+                               {AggregationType::CountAggregate, AggregationType::SumAggregate}};
+
+  auto make_executor = [&](bool batched) -> std::unique_ptr<AbstractExecutor> {
+    auto *ctx = GetExecutorContext();
+    std::unique_ptr<AbstractExecutor> left = std::make_unique<SeqScanExecutor>(ctx, &left_plan);
+    std::unique_ptr<AbstractExecutor> right = std::make_unique<SeqScanExecutor>(ctx, &right_plan);
+    if (!batched) {
+      left = std::make_unique<TupleAtATimeExecutor>(std::move(left));
+      right = std::make_unique<TupleAtATimeExecutor>(std::move(right));
+    }
+    std::unique_ptr<AbstractExecutor> join =
+        std::make_unique<HashJoinExecutor>(ctx, &join_plan, std::move(left), std::move(right));
+    if (!batched) {
+      join = std::make_unique<TupleAtATimeExecutor>(std::move(join));
+    }
+    return std::make_unique<AggregationExecutor>(ctx, &agg_plan, std::move(join));
+  };
+
+  const int runs = 10;
+  std::map<int32_t, std::pair<int32_t, int32_t>> tuple_groups;
+  auto start = std::chrono::steady_clock::now();
+  for (int run = 0; run < runs; run++) {
+    auto executor = make_executor(false);
+    executor->Init();
+    Tuple tuple;
+    RID rid;
+    while (executor->Next(&tuple, &rid)) {
+      tuple_groups[tuple.GetValue(agg_schema, 0).GetAs<int32_t>()] = {tuple.GetValue(agg_schema, 1).GetAs<int32_t>(),
+                                                                      tuple.GetValue(agg_schema, 2).GetAs<int32_t>()};
+    }
+  }
+  auto tuple_elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::map<int32_t, std::pair<int32_t, int32_t>> batch_groups;
+  start = std::chrono::steady_clock::now();
+  for (int run = 0; run < runs; run++) {
+    auto executor = make_executor(true);
+    executor->Init();
+    TupleBatch batch;
+    while (executor->NextBatch(&batch)) {
+      for (size_t i = 0; i < batch.Size(); i++) {
+        const Tuple &tuple = batch.GetTuple(i);
+        batch_groups[tuple.GetValue(agg_schema, 0).GetAs<int32_t>()] = {
+            tuple.GetValue(agg_schema, 1).GetAs<int32_t>(), tuple.GetValue(agg_schema, 2).GetAs<int32_t>()};
+      }
+    }
+  }
+  auto batch_elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  LOG_INFO("%d runs took %.3f s a tuple at a time and %.3f s a batch at a time", runs, tuple_elapsed,  // NOLINT
+           batch_elapsed);
+
+  // colA is serial, so every left tuple joins exactly one right tuple
+  ASSERT_EQ(tuple_groups, batch_groups);
+  int32_t count = 0;
+  for (const auto &group : batch_groups) {
+    count += group.second.first;
+  }
+  ASSERT_EQ(count, 900);
+}
+
 }  // namespace bustub
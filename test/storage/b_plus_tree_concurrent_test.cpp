@@ -10,12 +10,14 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <atomic>
 #include <chrono>  // NOLINT
 #include <cstdio>
 #include <functional>
 #include <thread>  // NOLINT
 
 #include "buffer/buffer_pool_manager_instance.h"
+#include "common/logger.h"
 #include "gtest/gtest.h"
 #include "storage/index/b_plus_tree.h"
 #include "test_util.h"  // NOLINT
@@ -100,7 +102,7 @@ void DeleteHelperSplit(BPlusTree<GenericKey<8>, RID, GenericComparator<8>> *tree
   delete transaction;
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest1) {
+TEST(BPlusTreeConcurrentTest, InsertTest1) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -152,7 +154,7 @@ TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest1) {
   remove("test.log");
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest2) {
+TEST(BPlusTreeConcurrentTest, InsertTest2) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -203,7 +205,7 @@ TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest2) {
   remove("test.log");
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest1) {
+TEST(BPlusTreeConcurrentTest, DeleteTest1) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -245,7 +247,7 @@ TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest1) {
   remove("test.log");
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest2) {
+TEST(BPlusTreeConcurrentTest, DeleteTest2) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -288,7 +290,7 @@ TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest2) {
   remove("test.log");
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_MixTest) {
+TEST(BPlusTreeConcurrentTest, MixTest) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -333,4 +335,155 @@ TEST(BPlusTreeConcurrentTest, DISABLED_MixTest) {
   remove("test.log");
 }
 
+TEST(BPlusTreeConcurrentTest, ReadDuringSplitAndMergeTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(100, disk_manager);
+  // small pages make the writers split, merge and redistribute pages all the time
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 4, 4);
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // the multiples of 4 stay in the tree, the writers insert and delete the keys between them
+  const int64_t num_keys = 2000;
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < num_keys; key += 4) {
+    keys.push_back(key);
+  }
+  InsertHelper(&tree, keys);
+
+  const int num_writers = 2;
+  std::atomic<int> running_writers{num_writers};
+  auto worker = [&tree, &running_writers, num_keys](uint64_t thread_itr) {
+    GenericKey<8> index_key;
+    RID rid;
+    if (thread_itr < num_writers) {
+      for (int round = 0; round < 4; round++) {
+        for (int64_t key = 1 + thread_itr; key < num_keys; key += (key % 4 == 3 ? 2 : 1)) {
+          rid.Set(static_cast<int32_t>(key >> 32), key & 0xFFFFFFFF);
+          index_key.SetFromInteger(key);
+          tree.Insert(index_key, rid);
+        }
+        for (int64_t key = 1 + thread_itr; key < num_keys; key += (key % 4 == 3 ? 2 : 1)) {
+          index_key.SetFromInteger(key);
+          tree.Remove(index_key);
+        }
+      }
+      running_writers--;
+      return;
+    }
+    // the readers latch one page at a time, and never miss a key that stays in the tree
+    std::vector<RID> rids;
+    int64_t key = 0;
+    while (running_writers > 0) {
+      key = (key + 36) % num_keys;
+      rids.clear();
+      index_key.SetFromInteger(key);
+      EXPECT_TRUE(tree.GetValue(index_key, &rids)) << "key " << key;
+      int64_t next_key = 0;
+      for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+        int64_t found = (*iterator).second.GetSlotNum();
+        if (found % 4 == 0) {
+          EXPECT_EQ(found, next_key);
+          next_key = found + 4;
+        }
+      }
+      EXPECT_EQ(next_key, num_keys);
+    }
+  };
+  LaunchParallelTest(num_writers + 2, worker);
+
+  int64_t size = 0;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), size * 4);
+    size = size + 1;
+  }
+  EXPECT_EQ(size, num_keys / 4);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeConcurrentTest, MixedWorkloadBenchmarkTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(100, disk_manager);
+  // small pages make the tree deep, so splits and merges keep crossing the levels
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 8, 8);
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // every thread inserts, looks up and deletes its own keys while the others do the same
+  const int num_threads = 4;
+  const int64_t num_keys = 20000;
+  auto worker = [&tree](uint64_t thread_itr) {
+    GenericKey<8> index_key;
+    RID rid;
+    auto *transaction = new Transaction(0);
+    std::vector<RID> rids;
+    for (int64_t key = static_cast<int64_t>(thread_itr); key < num_keys; key += num_threads) {
+      rid.Set(static_cast<int32_t>(key >> 32), key & 0xFFFFFFFF);
+      index_key.SetFromInteger(key);
+      EXPECT_TRUE(tree.Insert(index_key, rid, transaction));
+    }
+    for (int64_t key = static_cast<int64_t>(thread_itr); key < num_keys; key += num_threads) {
+      rids.clear();
+      index_key.SetFromInteger(key);
+      EXPECT_TRUE(tree.GetValue(index_key, &rids, transaction));
+      EXPECT_EQ(rids.size(), 1);
+    }
+    for (int64_t key = static_cast<int64_t>(thread_itr); key < num_keys; key += 2 * num_threads) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key, transaction);
+    }
+    delete transaction;
+  };
+
+  auto start = std::chrono::steady_clock::now();
+  LaunchParallelTest(num_threads, worker);
+  auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  LOG_INFO("%d threads ran %ld operations in %.3f s", num_threads, static_cast<long>(num_keys * 5 / 2),  // NOLINT
+           elapsed);
+
+  // the keys deleted by each thread are every other key of its stripe
+  std::vector<RID> rids;
+  GenericKey<8> index_key;
+  for (int64_t key = 0; key < num_keys; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    bool removed = (key / num_threads) % 2 == 0;
+    EXPECT_EQ(tree.GetValue(index_key, &rids), !removed) << "key " << key;
+  }
+  int64_t size = 0;
+  int64_t previous_key = -1;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    int64_t key = (*iterator).second.GetSlotNum();
+    EXPECT_LT(previous_key, key);
+    previous_key = key;
+    size = size + 1;
+  }
+  EXPECT_EQ(size, num_keys / 2);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
 }  // namespace bustub
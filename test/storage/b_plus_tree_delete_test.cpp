@@ -20,7 +20,7 @@
 
 namespace bustub {
 
-TEST(BPlusTreeTests, DISABLED_DeleteTest1) {
+TEST(BPlusTreeTests, DeleteTest1) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -98,7 +98,7 @@ TEST(BPlusTreeTests, DISABLED_DeleteTest1) {
   remove("test.log");
 }
 
-TEST(BPlusTreeTests, DISABLED_DeleteTest2) {
+TEST(BPlusTreeTests, DeleteTest2) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -175,4 +175,98 @@ TEST(BPlusTreeTests, DISABLED_DeleteTest2) {
   remove("test.db");
   remove("test.log");
 }
+
+TEST(BPlusTreeTests, LazyMergeTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // create b+ tree, removes merge a leaf only once it holds less than 2 of its 9 pairs
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 9, 5);
+  GenericKey<8> index_key;
+  RID rid;
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // collect the sizes of the leaves from left to right
+  auto leaf_sizes = [&]() {
+    std::vector<int> sizes;
+    Page *page = tree.FindLeafPage(index_key, true);
+    page_id_t leaf_page_id = page->GetPageId();
+    page->RUnlatch();
+    bpm->UnpinPage(leaf_page_id, false);
+    while (leaf_page_id != INVALID_PAGE_ID) {
+      auto *leaf = reinterpret_cast<BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>> *>(
+          bpm->FetchPage(leaf_page_id)->GetData());
+      sizes.push_back(leaf->GetSize());
+      page_id_t next_page_id = leaf->GetNextPageId();
+      bpm->UnpinPage(leaf_page_id, false);
+      leaf_page_id = next_page_id;
+    }
+    return sizes;
+  };
+
+  // the leaves hold 5 or 6 pairs each
+  const int64_t num_keys = 1000;
+  std::vector<std::pair<GenericKey<8>, RID>> pairs;
+  for (int64_t key = 0; key < num_keys; key++) {
+    rid.Set(static_cast<int32_t>(key >> 32), key & 0xFFFFFFFF);
+    index_key.SetFromInteger(key);
+    pairs.emplace_back(index_key, rid);
+  }
+  EXPECT_TRUE(tree.BulkLoad(pairs, nullptr, 0.75));
+  size_t num_leaves = leaf_sizes().size();
+
+  // removing every other key leaves all leaves underfull, but none of them is merged
+  for (int64_t key = 0; key < num_keys; key += 2) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key);
+  }
+  auto sizes = leaf_sizes();
+  EXPECT_EQ(sizes.size(), num_leaves);
+  for (int size : sizes) {
+    EXPECT_GE(size, 2);
+    EXPECT_LT(size, 4);
+  }
+
+  // compaction brings every leaf back to at least half of its pairs
+  EXPECT_GT(tree.Compact(), 0);
+  sizes = leaf_sizes();
+  EXPECT_LT(sizes.size(), num_leaves);
+  for (int size : sizes) {
+    EXPECT_GE(size, 4);
+  }
+  EXPECT_EQ(tree.Compact(), 0);
+
+  int64_t current_key = 1;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key = current_key + 2;
+  }
+  EXPECT_EQ(current_key, num_keys + 1);
+  std::vector<RID> rids;
+  for (int64_t key = 0; key < num_keys; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_EQ(tree.GetValue(index_key, &rids), key % 2 == 1);
+  }
+
+  // a leaf below the merge size is still merged by the remove itself
+  for (int64_t key = 1; key < num_keys; key += 2) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key);
+  }
+  EXPECT_TRUE(tree.IsEmpty());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
 }  // namespace bustub
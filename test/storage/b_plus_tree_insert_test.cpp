@@ -12,15 +12,20 @@
 
 #include <algorithm>
 #include <cstdio>
+#include <numeric>
+#include <random>
+#include <set>
 
 #include "buffer/buffer_pool_manager_instance.h"
 #include "gtest/gtest.h"
 #include "storage/index/b_plus_tree.h"
+#include "storage/index/b_plus_tree_index.h"
 #include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
 
 namespace bustub {
 
-TEST(BPlusTreeTests, DISABLED_InsertTest1) {
+TEST(BPlusTreeTests, InsertTest1) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -78,7 +83,7 @@ TEST(BPlusTreeTests, DISABLED_InsertTest1) {
   remove("test.log");
 }
 
-TEST(BPlusTreeTests, DISABLED_InsertTest2) {
+TEST(BPlusTreeTests, InsertTest2) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -145,4 +150,507 @@ TEST(BPlusTreeTests, DISABLED_InsertTest2) {
   remove("test.db");
   remove("test.log");
 }
+
+TEST(BPlusTreeTests, BulkLoadTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // create b+ tree
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 9, 5);
+  GenericKey<8> index_key;
+  RID rid;
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // the pairs are not ordered and contain a duplicate key
+  const int64_t num_keys = 1000;
+  std::vector<std::pair<GenericKey<8>, RID>> pairs;
+  for (int64_t i = 0; i < num_keys; i++) {
+    int64_t key = (i * 7) % num_keys;
+    rid.Set(static_cast<int32_t>(key >> 32), key & 0xFFFFFFFF);
+    index_key.SetFromInteger(key);
+    pairs.emplace_back(index_key, rid);
+  }
+  pairs.push_back(pairs.front());
+  EXPECT_TRUE(tree.BulkLoad(pairs, nullptr, 0.75));
+
+  // the leaves hold 3/4 of the 8 pairs that fit before a split, spread evenly over the leaves
+  Page *page = tree.FindLeafPage(index_key, true);
+  page_id_t leaf_page_id = page->GetPageId();
+  page->RUnlatch();
+  bpm->UnpinPage(leaf_page_id, false);
+  int64_t num_leaves = 0;
+  while (leaf_page_id != INVALID_PAGE_ID) {
+    auto *leaf = reinterpret_cast<BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>> *>(
+        bpm->FetchPage(leaf_page_id)->GetData());
+    EXPECT_GE(leaf->GetSize(), 5);
+    EXPECT_LE(leaf->GetSize(), 6);
+    num_leaves++;
+    page_id_t next_page_id = leaf->GetNextPageId();
+    bpm->UnpinPage(leaf_page_id, false);
+    leaf_page_id = next_page_id;
+  }
+  EXPECT_EQ(num_leaves, (num_keys + 5) / 6);
+
+  int64_t current_key = 0;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key = current_key + 1;
+  }
+  EXPECT_EQ(current_key, num_keys);
+
+  // the loaded tree keeps working for inserts and removes
+  std::vector<RID> rids;
+  for (int64_t key = num_keys; key < 2 * num_keys; key++) {
+    rid.Set(static_cast<int32_t>(key >> 32), key & 0xFFFFFFFF);
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.Insert(index_key, rid));
+  }
+  for (int64_t key = 0; key < 2 * num_keys; key += 2) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key);
+  }
+  for (int64_t key = 0; key < 2 * num_keys; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_EQ(tree.GetValue(index_key, &rids), key % 2 == 1);
+  }
+
+  // a tree that is not empty any more takes the pairs one by one
+  EXPECT_FALSE(tree.BulkLoad(pairs));
+  current_key = 0;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    current_key = current_key + 1;
+  }
+  EXPECT_EQ(current_key, num_keys + num_keys / 2);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, BatchTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // create b+ tree
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 5, 4);
+  GenericKey<8> index_key;
+  RID rid;
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // the even keys go in one by one, the batches are shuffled, overlap with them and repeat keys
+  const int64_t num_keys = 2000;
+  for (int64_t key = 0; key < num_keys; key += 2) {
+    rid.Set(static_cast<int32_t>(key >> 32), key & 0xFFFFFFFF);
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.Insert(index_key, rid));
+  }
+  std::vector<int64_t> keys(num_keys);
+  std::iota(keys.begin(), keys.end(), 0);
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  for (size_t offset = 0; offset < keys.size(); offset += 250) {
+    std::vector<std::pair<GenericKey<8>, RID>> pairs;
+    for (size_t i = offset; i < offset + 250; i++) {
+      rid.Set(static_cast<int32_t>(keys[i] >> 32), keys[i] & 0xFFFFFFFF);
+      index_key.SetFromInteger(keys[i]);
+      pairs.emplace_back(index_key, rid);
+    }
+    pairs.push_back(pairs.back());
+    int expected = 0;
+    for (size_t i = offset; i < offset + 250; i++) {
+      expected += keys[i] % 2;
+    }
+    EXPECT_EQ(tree.BatchInsert(pairs), expected);
+  }
+
+  int64_t current_key = 0;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key = current_key + 1;
+  }
+  EXPECT_EQ(current_key, num_keys);
+
+  // the results follow the order of the keys, including the missing ones
+  std::vector<GenericKey<8>> lookup_keys;
+  for (int64_t key : keys) {
+    index_key.SetFromInteger(key + num_keys / 2);
+    lookup_keys.push_back(index_key);
+  }
+  std::vector<std::optional<RID>> results;
+  tree.BatchLookup(lookup_keys, &results);
+  ASSERT_EQ(results.size(), keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    int64_t key = keys[i] + num_keys / 2;
+    ASSERT_EQ(results[i].has_value(), key < num_keys);
+    if (key < num_keys) {
+      EXPECT_EQ(results[i]->GetSlotNum(), key);
+    }
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, RangeIteratorTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // create b+ tree
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 3, 3);
+  GenericKey<8> index_key;
+  GenericKey<8> upper_key;
+  RID rid;
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // an empty tree has no entries in either direction
+  EXPECT_TRUE(tree.Begin(index_key, index_key).IsEnd());
+  EXPECT_TRUE(tree.RBegin().IsEnd());
+
+  // the odd keys below 200, after removing every third of them
+  std::set<int64_t> keys;
+  for (int64_t key = 1; key < 200; key += 2) {
+    rid.Set(static_cast<int32_t>(key >> 32), key & 0xFFFFFFFF);
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, rid);
+    keys.insert(key);
+  }
+  for (int64_t key = 1; key < 200; key += 6) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key);
+    keys.erase(key);
+  }
+
+  std::vector<int64_t> expected;
+  std::vector<int64_t> actual;
+  for (auto iterator = tree.RBegin(); !iterator.IsEnd(); ++iterator) {
+    actual.push_back((*iterator).first.ToString());
+  }
+  expected.assign(keys.rbegin(), keys.rend());
+  EXPECT_EQ(actual, expected);
+
+  // many more iterators than frames in the buffer pool, so none of them may keep a page pinned
+  std::mt19937 rng(15445);
+  for (int i = 0; i < 500; i++) {
+    int64_t lower = static_cast<int64_t>(rng() % 210) - 5;
+    int64_t upper = lower + static_cast<int64_t>(rng() % 40) - 5;
+    index_key.SetFromInteger(lower);
+    upper_key.SetFromInteger(upper);
+
+    expected.clear();
+    actual.clear();
+    for (auto key = keys.lower_bound(lower); key != keys.end() && *key <= upper; ++key) {
+      expected.push_back(*key);
+    }
+    for (auto iterator = tree.Begin(index_key, upper_key); iterator != tree.End(); ++iterator) {
+      actual.push_back((*iterator).first.ToString());
+    }
+    EXPECT_EQ(actual, expected) << "[" << lower << ", " << upper << "]";
+
+    std::reverse(expected.begin(), expected.end());
+    actual.clear();
+    for (auto iterator = tree.RBegin(index_key, upper_key); iterator != tree.End(); ++iterator) {
+      actual.push_back((*iterator).first.ToString());
+    }
+    EXPECT_EQ(actual, expected) << "reverse [" << lower << ", " << upper << "]";
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, GenericComparatorTest) {
+  // a composite key with an uninlined column and NULLs in the inlined columns
+  std::vector<Column> columns{};
+  columns.emplace_back("a", TypeId::INTEGER);
+  columns.emplace_back("b", TypeId::VARCHAR, 16);
+  columns.emplace_back("c", TypeId::BIGINT);
+  columns.emplace_back("d", TypeId::DECIMAL);
+  auto key_schema = std::make_unique<Schema>(columns);
+  GenericComparator<64> comparator(key_schema.get());
+
+  std::mt19937 rng(15445);
+  const std::vector<std::string> strings{"", "a", "ab", "abc", "b", "ba"};
+  std::vector<GenericKey<64>> keys;
+  for (int i = 0; i < 200; i++) {
+    std::vector<Value> values;
+    values.push_back(rng() % 8 == 0 ? ValueFactory::GetNullValueByType(TypeId::INTEGER)
+                                    : ValueFactory::GetIntegerValue(static_cast<int32_t>(rng() % 3) - 1));
+    values.push_back(ValueFactory::GetVarcharValue(strings[rng() % strings.size()]));
+    values.push_back(rng() % 8 == 0 ? ValueFactory::GetNullValueByType(TypeId::BIGINT)
+                                    : ValueFactory::GetBigIntValue(static_cast<int64_t>(rng() % 3) - 1));
+    values.push_back(rng() % 8 == 0 ? ValueFactory::GetNullValueByType(TypeId::DECIMAL)
+                                    : ValueFactory::GetDecimalValue(static_cast<double>(rng() % 3) - 0.5));
+    GenericKey<64> key;
+    key.SetFromKey(Tuple(values, key_schema.get()));
+    keys.push_back(key);
+  }
+
+  // the raw comparison agrees with comparing the deserialized values column by column
+  for (const auto &lhs : keys) {
+    for (const auto &rhs : keys) {
+      int expected = 0;
+      for (uint32_t i = 0; i < key_schema->GetColumnCount() && expected == 0; i++) {
+        Value lhs_value = lhs.ToValue(key_schema.get(), i);
+        Value rhs_value = rhs.ToValue(key_schema.get(), i);
+        if (lhs_value.CompareLessThan(rhs_value) == CmpBool::CmpTrue) {
+          expected = -1;
+        } else if (lhs_value.CompareGreaterThan(rhs_value) == CmpBool::CmpTrue) {
+          expected = 1;
+        }
+      }
+      EXPECT_EQ(comparator(lhs, rhs), expected);
+    }
+  }
+}
+
+TEST(BPlusTreeTests, KeyWidthTest) {
+  // a key of this schema occupies 14 of the 64 key bytes
+  std::vector<Column> columns{};
+  columns.emplace_back("a", TypeId::INTEGER);
+  columns.emplace_back("b", TypeId::BIGINT);
+  columns.emplace_back("c", TypeId::SMALLINT);
+  Schema table_schema(columns);
+  auto metadata = std::make_unique<IndexMetadata>("index", "table", &table_schema, std::vector<uint32_t>{0, 1, 2});
+  const Schema *key_schema = metadata->GetKeySchema();
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // create header_page
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  BPlusTreeIndex<GenericKey<64>, RID, GenericComparator<64>> index(std::move(metadata), bpm);
+  GenericComparator<64> comparator(const_cast<Schema *>(key_schema));
+
+  auto make_key = [key_schema](int64_t i) {
+    return Tuple({ValueFactory::GetIntegerValue(static_cast<int32_t>(i % 7)), ValueFactory::GetBigIntValue(i * 3),
+                  ValueFactory::GetSmallIntValue(static_cast<int16_t>(i % 5))},
+                 key_schema);
+  };
+  const int64_t num_keys = 2000;
+  for (int64_t i = 0; i < num_keys; i++) {
+    index.InsertEntry(make_key(i), RID(static_cast<int32_t>(i >> 32), static_cast<int32_t>(i)), nullptr);
+  }
+
+  for (int64_t i = 0; i < num_keys; i++) {
+    std::vector<RID> rids;
+    index.ScanKey(make_key(i), &rids, nullptr);
+    ASSERT_EQ(rids.size(), 1);
+    EXPECT_EQ(rids[0].GetSlotNum(), i);
+  }
+  for (int64_t i = 0; i < num_keys; i += 2) {
+    index.DeleteEntry(make_key(i), RID(static_cast<int32_t>(i >> 32), static_cast<int32_t>(i)), nullptr);
+  }
+
+  // the remaining keys come out in order, followed by their rid and zeros
+  int64_t count = 0;
+  GenericKey<64> previous;
+  for (auto iterator = index.GetBeginIterator(); iterator != index.GetEndIterator(); ++iterator) {
+    const auto &[key, rid] = *iterator;
+    GenericKey<64> expected;
+    expected.SetFromKey(make_key(rid.GetSlotNum()));
+    EXPECT_EQ(comparator(key, expected), 0);
+    EXPECT_EQ(std::memcmp(key.data_, expected.data_, 14), 0);
+    EXPECT_EQ(std::memcmp(key.data_ + 14, &rid, sizeof(RID)), 0);
+    EXPECT_EQ(std::memcmp(key.data_ + 14 + sizeof(RID), expected.data_ + 14 + sizeof(RID), 64 - 14 - sizeof(RID)), 0);
+    EXPECT_EQ(rid.GetSlotNum() % 2, 1);
+    if (count > 0) {
+      EXPECT_LT(comparator(previous, key), 0);
+    }
+    previous = key;
+    count++;
+  }
+  EXPECT_EQ(count, num_keys / 2);
+
+  // varchar values may be longer than declared, so a varchar key keeps every key byte
+  std::vector<Column> varchar_columns{};
+  varchar_columns.emplace_back("a", TypeId::INTEGER);
+  varchar_columns.emplace_back("b", TypeId::VARCHAR, 8);
+  Schema varchar_schema(varchar_columns);
+  auto varchar_metadata =
+      std::make_unique<IndexMetadata>("varchar_index", "table", &varchar_schema, std::vector<uint32_t>{0, 1});
+  const Schema *varchar_key_schema = varchar_metadata->GetKeySchema();
+  BPlusTreeIndex<GenericKey<64>, RID, GenericComparator<64>> varchar_index(std::move(varchar_metadata), bpm);
+  Tuple long_key({ValueFactory::GetIntegerValue(0), ValueFactory::GetVarcharValue("k123456789")}, varchar_key_schema);
+  varchar_index.InsertEntry(long_key, RID(0, 1), nullptr);
+  std::vector<RID> rids;
+  varchar_index.ScanKey(long_key, &rids, nullptr);
+  ASSERT_EQ(rids.size(), 1);
+  EXPECT_EQ(rids[0].GetSlotNum(), 1);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, DuplicateKeyTest) {
+  // an integer key leaves room for the rid in 16 key bytes, but not in 8
+  std::vector<Column> columns{};
+  columns.emplace_back("a", TypeId::INTEGER);
+  Schema table_schema(columns);
+  auto metadata = std::make_unique<IndexMetadata>("index", "table", &table_schema, std::vector<uint32_t>{0});
+  auto small_metadata = std::make_unique<IndexMetadata>("small", "table", &table_schema, std::vector<uint32_t>{0});
+  const Schema *key_schema = metadata->GetKeySchema();
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // create header_page
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  BPlusTreeIndex<GenericKey<16>, RID, GenericComparator<16>> index(std::move(metadata), bpm);
+  // entries of equal keys would replace each other without the rid, so the key type is rejected
+  using SmallIndex = BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>;
+  EXPECT_THROW(SmallIndex(std::move(small_metadata), bpm), Exception);
+
+  auto make_key = [key_schema](int32_t i) { return Tuple({ValueFactory::GetIntegerValue(i)}, key_schema); };
+  const int32_t num_keys = 50;
+  const int32_t num_rids = 40;
+  for (int32_t rid = num_rids - 1; rid >= 0; rid--) {
+    for (int32_t i = 0; i < num_keys; i++) {
+      index.InsertEntry(make_key(i), RID(rid, i), nullptr);
+    }
+  }
+
+  // every key finds all of its rids, in rid order
+  for (int32_t i = 0; i < num_keys; i++) {
+    std::vector<RID> rids;
+    index.ScanKey(make_key(i), &rids, nullptr);
+    ASSERT_EQ(rids.size(), num_rids);
+    for (int32_t rid = 0; rid < num_rids; rid++) {
+      EXPECT_EQ(rids[rid], RID(rid, i));
+    }
+  }
+
+  // deleting an entry leaves the other entries of its key alone
+  for (int32_t i = 0; i < num_keys; i++) {
+    for (int32_t rid = 0; rid < num_rids; rid += 2) {
+      index.DeleteEntry(make_key(i), RID(rid, i), nullptr);
+    }
+  }
+  for (int32_t i = 0; i < num_keys; i++) {
+    std::vector<RID> rids;
+    index.ScanKey(make_key(i), &rids, nullptr);
+    ASSERT_EQ(rids.size(), num_rids / 2);
+    for (const RID &rid : rids) {
+      EXPECT_EQ(rid.GetPageId() % 2, 1);
+    }
+  }
+  std::vector<RID> rids;
+  index.ScanKey(make_key(num_keys), &rids, nullptr);
+  EXPECT_TRUE(rids.empty());
+
+  // a bounded scan returns all entries of the keys in its range
+  GenericKey<16> lower;
+  GenericKey<16> upper;
+  lower.SetFromKey(make_key(10));
+  upper.SetFromKey(make_key(19));
+  int64_t count = 0;
+  for (auto iterator = index.GetBeginIterator(lower, upper); !iterator.IsEnd(); ++iterator) {
+    count++;
+  }
+  EXPECT_EQ(count, 10 * num_rids / 2);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, VarcharDuplicateKeyTest) {
+  // a varchar key keeps 24 of the 32 key bytes, leaving room for the rid, and longer keys are cut off
+  std::vector<Column> columns{};
+  columns.emplace_back("a", TypeId::VARCHAR, 8);
+  Schema table_schema(columns);
+  auto metadata = std::make_unique<IndexMetadata>("index", "table", &table_schema, std::vector<uint32_t>{0});
+  const Schema *key_schema = metadata->GetKeySchema();
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // create header_page
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  BPlusTreeIndex<GenericKey<32>, RID, GenericComparator<32>> index(std::move(metadata), bpm);
+
+  // the last two keys only differ behind the stored characters
+  std::vector<std::string> strings{"", "a", "b", "k1", "k10", "k2", "abcdefghijklmnop_first", "abcdefghijklmnop_second"};
+  auto make_key = [key_schema, &strings](size_t i) {
+    return Tuple({ValueFactory::GetVarcharValue(strings[i])}, key_schema);
+  };
+  const int32_t num_rids = 100;
+  for (int32_t rid = 0; rid < num_rids; rid++) {
+    for (size_t i = 0; i < strings.size(); i++) {
+      index.InsertEntry(make_key(i), RID(rid, static_cast<uint32_t>(i)), nullptr);
+    }
+  }
+  for (size_t i = 0; i < strings.size(); i++) {
+    for (int32_t rid = 0; rid < num_rids; rid += 2) {
+      index.DeleteEntry(make_key(i), RID(rid, static_cast<uint32_t>(i)), nullptr);
+    }
+  }
+
+  // every key finds all of its remaining rids, keys that were cut off also find those of the same stored prefix
+  for (size_t i = 0; i < strings.size(); i++) {
+    std::vector<RID> rids;
+    index.ScanKey(make_key(i), &rids, nullptr);
+    size_t expected_keys = strings[i].size() > 16 ? 2 : 1;
+    ASSERT_EQ(rids.size(), expected_keys * num_rids / 2) << strings[i];
+    for (const RID &rid : rids) {
+      EXPECT_EQ(rid.GetPageId() % 2, 1);
+      if (expected_keys == 1) {
+        EXPECT_EQ(rid.GetSlotNum(), i);
+      }
+    }
+  }
+
+  // the entries come out ordered by key and rid
+  int64_t count = 0;
+  GenericComparator<32> comparator(const_cast<Schema *>(key_schema), 24);
+  GenericKey<32> previous;
+  for (auto iterator = index.GetBeginIterator(); iterator != index.GetEndIterator(); ++iterator) {
+    if (count > 0) {
+      EXPECT_LT(comparator(previous, (*iterator).first), 0);
+    }
+    previous = (*iterator).first;
+    count++;
+  }
+  EXPECT_EQ(count, strings.size() * num_rids / 2);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
 }  // namespace bustub